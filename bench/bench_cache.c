@@ -0,0 +1,224 @@
+/*
+		Copyright (C) 2023
+			Pribess (Heewon Cho)
+			Jhyub	(Janghyub Seo)
+		bench/bench_cache.c
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../src/cache/response.h"
+
+extern struct config isr_config;
+
+/*
+	Replays Zipf-distributed query streams against the response cache and against
+	a plain LRU given the same byte budget, charging every entry the way
+	isr_response_cache_store does, and prints the hit ratio of both.
+	The scan workloads interleave one-off names, as a random subdomain attack would.
+	Each run gets a process of its own, so no cache or ghost queue is carried over.
+*/
+
+#define ISR_BENCH_KEYS 100000
+#define ISR_BENCH_REQUESTS 2000000
+#define ISR_BENCH_WIRE 64
+#define ISR_BENCH_TTL_OFFSET 40
+
+struct bench_workload {
+	const char *label;
+	double alpha;
+	unsigned int scan_percent; /* requests for names never asked again */
+};
+
+struct bench_lru_entry {
+	struct bench_lru_entry *prev;
+	struct bench_lru_entry *next;
+	size_t charge;
+	bool cached;
+};
+
+struct bench_lru {
+	struct bench_lru_entry *head; /* most recent */
+	struct bench_lru_entry *tail;
+	struct bench_lru_entry *entries;
+	size_t bytes;
+	size_t capacity;
+};
+
+uint64_t isr_bench_seed = 88172645463325252ULL;
+
+uint64_t isr_bench_random() {
+	isr_bench_seed ^= isr_bench_seed << 13;
+	isr_bench_seed ^= isr_bench_seed >> 7;
+	isr_bench_seed ^= isr_bench_seed << 17;
+	return isr_bench_seed;
+}
+
+double *isr_bench_zipf(double alpha) {
+	double *cdf = malloc(ISR_BENCH_KEYS * sizeof(double));
+
+	double sum = 0;
+	for (size_t i = 0; i < ISR_BENCH_KEYS; i++) {
+		sum += 1.0 / pow(i + 1, alpha);
+		cdf[i] = sum;
+	}
+	for (size_t i = 0; i < ISR_BENCH_KEYS; i++) cdf[i] /= sum;
+
+	return cdf;
+}
+
+size_t isr_bench_zipf_key(double *cdf) {
+	double u = (double) (isr_bench_random() >> 11) / (double) (1ULL << 53);
+
+	size_t low = 0, high = ISR_BENCH_KEYS - 1;
+	while (low < high) {
+		size_t mid = (low + high) / 2;
+		if (cdf[mid] < u) low = mid + 1;
+		else high = mid;
+	}
+
+	return low;
+}
+
+/*
+	The same charge isr_response_cache_store accounts for an entry of one TTL,
+	the suffix "bench.example" being shared.
+*/
+size_t isr_bench_charge(const char *leaf) {
+	return sizeof(struct cached_response) + sizeof(struct name) + strlen(leaf) + ISR_BENCH_WIRE + sizeof(uint16_t) + sizeof(uint32_t);
+}
+
+void isr_bench_lru_unlink(struct bench_lru *lru, struct bench_lru_entry *entry) {
+	if (entry->prev != NULL) entry->prev->next = entry->next;
+	else lru->head = entry->next;
+	if (entry->next != NULL) entry->next->prev = entry->prev;
+	else lru->tail = entry->prev;
+}
+
+void isr_bench_lru_push(struct bench_lru *lru, struct bench_lru_entry *entry) {
+	entry->prev = NULL;
+	entry->next = lru->head;
+	if (lru->head != NULL) lru->head->prev = entry;
+	lru->head = entry;
+	if (lru->tail == NULL) lru->tail = entry;
+}
+
+bool isr_bench_lru_access(struct bench_lru *lru, struct bench_lru_entry *entry, size_t charge) {
+	if (entry->cached) {
+		isr_bench_lru_unlink(lru, entry);
+		isr_bench_lru_push(lru, entry);
+		return true;
+	}
+
+	while (lru->bytes + charge > lru->capacity && lru->tail != NULL) {
+		struct bench_lru_entry *victim = lru->tail;
+		isr_bench_lru_unlink(lru, victim);
+		victim->cached = false;
+		lru->bytes -= victim->charge;
+	}
+
+	entry->cached = true;
+	entry->charge = charge;
+	lru->bytes += charge;
+	isr_bench_lru_push(lru, entry);
+
+	return false;
+}
+
+void isr_bench_run(struct bench_workload *workload, size_t budget) {
+	double *cdf = isr_bench_zipf(workload->alpha);
+
+	isr_config.response_cache_bytes = budget;
+
+	struct bench_lru lru = {
+		.head = NULL,
+		.tail = NULL,
+		.entries = calloc(ISR_BENCH_KEYS + ISR_BENCH_REQUESTS, sizeof(struct bench_lru_entry)),
+		.bytes = 0,
+		.capacity = budget,
+	};
+
+	uint64_t seed = isr_bench_seed;
+	unsigned long s3fifo_hits = 0, lru_hits = 0, hot = 0;
+	struct timespec start, end;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	for (size_t i = 0; i < ISR_BENCH_REQUESTS; i++) {
+		size_t key = isr_bench_random() % 100 < workload->scan_percent ? ISR_BENCH_KEYS + i : isr_bench_zipf_key(cdf);
+		if (key < ISR_BENCH_KEYS) hot++;
+
+		char leaf[32], qname[64];
+		snprintf(leaf, sizeof(leaf), "k%zu", key);
+		snprintf(qname, sizeof(qname), "%s.bench.example", leaf);
+
+		struct question question = { .qname = qname, .qtype = 1, .qclass = 1 };
+
+		struct cached_response *cached = isr_response_cache_lookup(&question);
+		if (cached != NULL) {
+			if (key < ISR_BENCH_KEYS) s3fifo_hits++;
+		} else {
+			unsigned char *wire = calloc(ISR_BENCH_WIRE, sizeof(unsigned char));
+			*(uint32_t *)(wire + ISR_BENCH_TTL_OFFSET) = htonl(3600);
+
+			uint16_t ttl_offset = ISR_BENCH_TTL_OFFSET;
+			if (isr_response_cache_store(&question, 0, wire, ISR_BENCH_WIRE, 0, &ttl_offset, 1) == NULL) free(wire);
+		}
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	double elapsed = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+
+	/* The same stream again for LRU */
+	isr_bench_seed = seed;
+	for (size_t i = 0; i < ISR_BENCH_REQUESTS; i++) {
+		size_t key = isr_bench_random() % 100 < workload->scan_percent ? ISR_BENCH_KEYS + i : isr_bench_zipf_key(cdf);
+
+		char leaf[32];
+		snprintf(leaf, sizeof(leaf), "k%zu", key);
+
+		if (isr_bench_lru_access(&lru, &lru.entries[key], isr_bench_charge(leaf)) && key < ISR_BENCH_KEYS) lru_hits++;
+	}
+
+	printf("%-16s %8zu KiB  s3-fifo %6.2f%%  lru %6.2f%%  (%.0f ns/request)\n",
+		workload->label, budget / 1024,
+		100.0 * s3fifo_hits / hot, 100.0 * lru_hits / hot,
+		elapsed / ISR_BENCH_REQUESTS);
+
+	free(lru.entries);
+	free(cdf);
+}
+
+int main() {
+	struct bench_workload workloads[] = {
+		{ "zipf 0.8", 0.8, 0 },
+		{ "zipf 1.0", 1.0, 0 },
+		{ "zipf 1.2", 1.2, 0 },
+		{ "zipf 0.8 + scan", 0.8, 30 },
+		{ "zipf 1.0 + scan", 1.0, 30 },
+	};
+	size_t budgets[] = { 512 * 1024, 2 * 1024 * 1024 };
+
+	printf("hit ratio over the Zipf keys, %d keys, %d requests\n", ISR_BENCH_KEYS, ISR_BENCH_REQUESTS);
+
+	for (size_t i = 0; i < sizeof(workloads) / sizeof(workloads[0]); i++) {
+		for (size_t j = 0; j < sizeof(budgets) / sizeof(budgets[0]); j++) {
+			fflush(stdout);
+
+			pid_t pid = fork();
+			if (pid == 0) {
+				isr_bench_run(&workloads[i], budgets[j]);
+				exit(0);
+			}
+			waitpid(pid, NULL, 0);
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,125 @@
+/*
+		Copyright (C) 2023
+			Pribess (Heewon Cho)
+			Jhyub	(Janghyub Seo)
+		bench/bench_label.c
+*/
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../src/cache/name.h"
+#include "../src/packet/label.h"
+#include "../src/packet/view.h"
+#include "../src/packet/writer.h"
+
+/*
+	Times isr_label_fold, which lowercases and hashes a label 16 bytes at a time,
+	against the byte at a time tolower and FNV-1a loop the name arena used before it,
+	for labels of a few lengths, with the rest of a packet readable past the label
+	as it is while parsing. Then times finding an interned name from its dotted
+	form, as every cache lookup did before, against finding it from what
+	isr_view_parse already folded.
+*/
+
+#define ISR_BENCH_ROUNDS 20000000
+#define ISR_BENCH_FIND_ROUNDS 5000000
+
+uint32_t isr_bench_fnv_lower(const unsigned char *label, size_t length, unsigned char *lower) {
+	uint32_t ret = 2166136261u ^ (uint32_t) length;
+	ret *= 16777619u;
+
+	for (size_t i = 0; i < length; i++) {
+		lower[i] = tolower(label[i]);
+		ret ^= lower[i];
+		ret *= 16777619u;
+	}
+
+	return ret;
+}
+
+double isr_bench_elapsed(struct timespec *start) {
+	struct timespec end;
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	return (end.tv_sec - start->tv_sec) * 1e9 + (end.tv_nsec - start->tv_nsec);
+}
+
+void isr_bench_fold(size_t length) {
+	unsigned char label[64 + ISR_LABEL_SLACK];
+	unsigned char lower[64 + ISR_LABEL_SLACK];
+	for (size_t i = 0; i < length; i++) label[i] = "AbCdEfGhIjKlMnOpQrStUvWxYz-0123"[i % 31];
+
+	volatile uint32_t sink = 0;
+	struct timespec start;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (size_t i = 0; i < ISR_BENCH_ROUNDS; i++) {
+		label[0] = 'A' + i % 26;
+		sink += isr_label_fold(label, length, sizeof(label), lower);
+	}
+	double fold_ns = isr_bench_elapsed(&start) / ISR_BENCH_ROUNDS;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (size_t i = 0; i < ISR_BENCH_ROUNDS; i++) {
+		label[0] = 'A' + i % 26;
+		sink += isr_bench_fnv_lower(label, length, lower);
+	}
+	double fnv_ns = isr_bench_elapsed(&start) / ISR_BENCH_ROUNDS;
+
+	printf("label of %2zu   isr_label_fold %5.2f ns   tolower + fnv %6.2f ns   %4.1fx\n", length, fold_ns, fnv_ns, fnv_ns / fold_ns);
+}
+
+void isr_bench_find(const char *name) {
+	struct name *interned = isr_name_intern(name);
+
+	unsigned char query[512];
+	struct header header = { .rd = 1, .qdcount = 0 };
+	struct question question = { .qname = (char *) name, .qtype = 1, .qclass = 1 };
+
+	struct packet_writer writer;
+	isr_writer_init(&writer, query, sizeof(query));
+	isr_writer_header(&writer, &header);
+	isr_writer_question(&writer, &question);
+
+	struct packet_view view;
+	isr_view_parse(&view, query, isr_writer_finish(&writer));
+
+	volatile size_t sink = 0;
+	struct timespec start;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (size_t i = 0; i < ISR_BENCH_FIND_ROUNDS; i++) {
+		sink += isr_name_find(name) == interned;
+	}
+	double dotted_ns = isr_bench_elapsed(&start) / ISR_BENCH_FIND_ROUNDS;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (size_t i = 0; i < ISR_BENCH_FIND_ROUNDS; i++) {
+		sink += isr_name_find_wire(view.lower, view.labels, view.label_hashes, view.labels_length) == interned;
+	}
+	double wire_ns = isr_bench_elapsed(&start) / ISR_BENCH_FIND_ROUNDS;
+
+	printf("%-60s dotted %6.2f ns   folded %6.2f ns\n", name, dotted_ns, wire_ns);
+
+	isr_name_release(interned);
+}
+
+int main() {
+	size_t lengths[] = { 3, 8, 16, 32, 63 };
+	for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) isr_bench_fold(lengths[i]);
+
+	printf("\n");
+
+	const char *names[] = {
+		"www.example.com",
+		"Mail.Corp.Example.COM",
+		"a-rather-long-label-of-some-length.cdn.provider.example.net",
+	};
+	for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) isr_bench_find(names[i]);
+
+	return 0;
+}
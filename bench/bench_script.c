@@ -0,0 +1,126 @@
+/*
+		Copyright (C) 2023
+			Pribess (Heewon Cho)
+			Jhyub	(Janghyub Seo)
+		bench/bench_script.c
+*/
+
+#include <jerryscript.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../src/script/engine.h"
+#include "../src/script/module.h"
+#include "../src/script/state.h"
+
+extern struct config isr_config;
+
+/*
+	Times what deciding a query in isr.js costs per query, for batches of 1 to 64
+	questions: once calling resolve() for each question, and once calling resolveBatch()
+	for the whole batch, both through isr_script_run_batch. The script answers every
+	question with the same A record and no cache hint, so no decision is reused and
+	what is measured is building the arguments, the call and reading back the result.
+*/
+
+#define ISR_BENCH_QUESTIONS 256000
+#define ISR_BENCH_BATCH_MAX 64
+
+const char isr_bench_script[] =
+	"import { Answer } from \"result.js\";\n"
+	"import { IPV4 } from \"rdata.js\";\n"
+	"import { Type } from \"type.js\";\n"
+	"const rdata = new IPV4(\"192.0.2.1\");\n"
+	"export function resolve(question, state) { return new Answer(Type.A, rdata); }\n"
+	"export function resolveBatch(questions, state) { return questions.map(question => new Answer(Type.A, rdata)); }\n";
+
+double isr_bench_elapsed(struct timespec *start) {
+	struct timespec end;
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	return (end.tv_sec - start->tv_sec) * 1e9 + (end.tv_nsec - start->tv_nsec);
+}
+
+double isr_bench_run(struct script_bindings *bindings, struct question **questions, size_t count) {
+	struct resolve_result *results[ISR_BENCH_BATCH_MAX];
+	size_t rounds = ISR_BENCH_QUESTIONS / count;
+	struct timespec start;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (size_t round = 0; round < rounds; round++) {
+		isr_script_run_batch(bindings, questions, count, NULL, 0, results);
+
+		for (size_t i = 0; i < count; i++) {
+			if (results[i]->type != ANSWER) {
+				printf("question %zu wasn't answered\n", i);
+				exit(1);
+			}
+			isr_resolve_result_free(results[i]);
+		}
+	}
+
+	return isr_bench_elapsed(&start) / (rounds * count);
+}
+
+int main() {
+	char dir[] = "/tmp/isr-bench-XXXXXX";
+	if (mkdtemp(dir) == NULL) {
+		perror("mkdtemp");
+		return 1;
+	}
+
+	char path[sizeof(dir) + 8];
+	snprintf(path, sizeof(path), "%s/isr.js", dir);
+
+	FILE *file = fopen(path, "w");
+	fputs(isr_bench_script, file);
+	fclose(file);
+
+	isr_config.getter_script_dir = dir;
+	isr_config.script_budget = 0;
+
+	jerry_init(JERRY_INIT_EMPTY);
+
+	jerry_value_t module = isr_script_load();
+	if (jerry_value_is_exception(module)) {
+		isr_script_report(module);
+		return 1;
+	}
+
+	struct script_bindings *bindings = isr_script_bind(module);
+	if (bindings == NULL) return 1;
+
+	char qnames[ISR_BENCH_BATCH_MAX][32];
+	struct question storage[ISR_BENCH_BATCH_MAX];
+	struct question *questions[ISR_BENCH_BATCH_MAX];
+	for (size_t i = 0; i < ISR_BENCH_BATCH_MAX; i++) {
+		snprintf(qnames[i], sizeof(qnames[i]), "host%zu.bench.example", i);
+		storage[i] = (struct question) { .qname = qnames[i], .qtype = 1, .qclass = 1 };
+		questions[i] = &storage[i];
+	}
+
+	printf("ns per question, %d questions each\n", ISR_BENCH_QUESTIONS);
+
+	jerry_value_t resolve_batch = bindings->resolve_batch;
+	for (size_t count = 1; count <= ISR_BENCH_BATCH_MAX; count *= 2) {
+		bindings->resolve_batch = jerry_undefined();
+		double resolve_ns = isr_bench_run(bindings, questions, count);
+
+		bindings->resolve_batch = resolve_batch;
+		double batch_ns = isr_bench_run(bindings, questions, count);
+
+		printf("batch of %2zu   resolve() %8.1f   resolveBatch() %8.1f   %4.2fx\n", count, resolve_ns, batch_ns, resolve_ns / batch_ns);
+	}
+
+	isr_script_unbind(bindings);
+	isr_module_registry_clear();
+	jerry_cleanup();
+
+	unlink(path);
+	rmdir(dir);
+
+	return 0;
+}
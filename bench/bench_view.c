@@ -0,0 +1,130 @@
+/*
+		Copyright (C) 2023
+			Pribess (Heewon Cho)
+			Jhyub	(Janghyub Seo)
+		bench/bench_view.c
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../src/packet/header.h"
+#include "../src/packet/question.h"
+#include "../src/packet/view.h"
+#include "../src/packet/writer.h"
+
+/*
+	Parses the same set of queries over and over, once with isr_view_parse on the
+	stack and once the way queries were read before it: a heap header from
+	isr_deserialize_header and a heap question with a strdup'd qname from
+	isr_deserialize_question. The view is timed both without and with asking
+	for the dotted qname, which it only produces on demand.
+*/
+
+#define ISR_BENCH_ROUNDS 2000000
+
+/* An OPT record for 1232 octets carrying an ECS option for 192.0.2.0/24 */
+const unsigned char isr_bench_opt[] = {
+	0x00, 0x00, 0x29, 0x04, 0xD0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0B,
+	0x00, 0x08, 0x00, 0x07, 0x00, 0x01, 0x18, 0x00, 0xC0, 0x00, 0x02,
+};
+
+const char *isr_bench_names[] = {
+	"a.io",
+	"www.example.com",
+	"Mail.Corp.Example.COM",
+	"a-rather-long-label-of-some-length.cdn.provider.example.net",
+	"1.2.3.4.5.6.7.8.9.a.b.c.d.e.f.0.ip6.arpa",
+	"dwhrvkgqxbctpzmaylns.random-subdomain.example.org",
+};
+
+#define ISR_BENCH_QUERIES (sizeof(isr_bench_names) / sizeof(isr_bench_names[0]) * 2)
+
+struct bench_query {
+	unsigned char wire[512];
+	size_t length;
+};
+
+void isr_bench_query(struct bench_query *query, const char *name, bool edns) {
+	struct header header = { .id = 0x1234, .rd = 1, .qdcount = 0, .arcount = 0 };
+	struct question question = { .qname = (char *) name, .qtype = 1, .qclass = 1 };
+
+	struct packet_writer writer;
+	isr_writer_init(&writer, query->wire, sizeof(query->wire));
+	isr_writer_header(&writer, &header);
+	isr_writer_question(&writer, &question);
+	query->length = isr_writer_finish(&writer);
+
+	if (edns) {
+		memcpy(query->wire + query->length, isr_bench_opt, sizeof(isr_bench_opt));
+		query->length += sizeof(isr_bench_opt);
+		query->wire[11] = 1;
+	}
+}
+
+double isr_bench_elapsed(struct timespec *start) {
+	struct timespec end;
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	return (end.tv_sec - start->tv_sec) * 1e9 + (end.tv_nsec - start->tv_nsec);
+}
+
+int main() {
+	struct bench_query queries[ISR_BENCH_QUERIES];
+	for (size_t i = 0; i < ISR_BENCH_QUERIES; i++) {
+		isr_bench_query(&queries[i], isr_bench_names[i / 2], i % 2 == 1);
+	}
+
+	struct packet_view view;
+	for (size_t i = 0; i < ISR_BENCH_QUERIES; i++) {
+		if (!isr_view_parse(&view, queries[i].wire, queries[i].length)) {
+			printf("query %zu doesn't parse\n", i);
+			return 1;
+		}
+	}
+
+	size_t total = (size_t) ISR_BENCH_ROUNDS * ISR_BENCH_QUERIES;
+	volatile size_t sink = 0;
+	struct timespec start;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (size_t round = 0; round < ISR_BENCH_ROUNDS; round++) {
+		for (size_t i = 0; i < ISR_BENCH_QUERIES; i++) {
+			isr_view_parse(&view, queries[i].wire, queries[i].length);
+			sink += view.hash + view.udp_size;
+		}
+	}
+	double view_ns = isr_bench_elapsed(&start) / total;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (size_t round = 0; round < ISR_BENCH_ROUNDS; round++) {
+		for (size_t i = 0; i < ISR_BENCH_QUERIES; i++) {
+			isr_view_parse(&view, queries[i].wire, queries[i].length);
+			sink += isr_view_qname(&view)[0];
+		}
+	}
+	double view_qname_ns = isr_bench_elapsed(&start) / total;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (size_t round = 0; round < ISR_BENCH_ROUNDS; round++) {
+		for (size_t i = 0; i < ISR_BENCH_QUERIES; i++) {
+			struct header *header = isr_deserialize_header(queries[i].wire);
+			struct question *question = isr_deserialize_question(queries[i].wire + 12, queries[i].length - 12, header->qdcount);
+			sink += question->qtype + question->qname[0];
+
+			free(question->qname);
+			free(question);
+			free(header);
+		}
+	}
+	double heap_ns = isr_bench_elapsed(&start) / total;
+
+	printf("%zu queries, %zu parses each\n", ISR_BENCH_QUERIES, (size_t) ISR_BENCH_ROUNDS);
+	printf("isr_view_parse           %6.1f ns/query  %6.2f Mqps\n", view_ns, 1e3 / view_ns);
+	printf("isr_view_parse + qname   %6.1f ns/query  %6.2f Mqps\n", view_qname_ns, 1e3 / view_qname_ns);
+	printf("heap header + question   %6.1f ns/query  %6.2f Mqps\n", heap_ns, 1e3 / heap_ns);
+
+	return 0;
+}
@@ -0,0 +1,88 @@
+/*
+		Copyright (C) 2023
+			Pribess (Heewon Cho)
+			Jhyub	(Janghyub Seo)
+		fuzz/fuzz_view.c
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/packet/question.h"
+#include "../src/packet/view.h"
+
+/*
+	Feeds arbitrary bytes to the query parser: isr_view_parse (and with it
+	isr_view_opt and isr_view_ecs), then isr_view_qname and isr_view_ttls on
+	whatever parsed, and isr_view_name from every offset that could start a name.
+	The input is copied to a buffer of exactly its size, so that a sanitizer
+	catches any read past the end of the packet.
+
+	Built by "make fuzz" as a libFuzzer target. With -DISR_FUZZ_MAIN it gets a main
+	of its own instead, which runs each file given, or stdin, once; that is
+	what AFL (FUZZ_CC=afl-clang-fast) or replaying a crash needs.
+*/
+
+#define ISR_FUZZ_SIZE 65535
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+	if (size > ISR_FUZZ_SIZE) return 0;
+
+	unsigned char *packet = malloc(size > 0 ? size : 1);
+	memcpy(packet, data, size);
+
+	struct packet_view view;
+	if (isr_view_parse(&view, packet, size)) {
+		const char *qname = isr_view_qname(&view);
+		if (strlen(qname) > 253) abort();
+
+		uint16_t ttl_offsets[64];
+		size_t ttl_offsets_length = 0;
+		if (isr_view_ttls(&view, ttl_offsets, &ttl_offsets_length, 64)) {
+			for (size_t i = 0; i < ttl_offsets_length; i++) {
+				if (ttl_offsets[i] + 4 > size) abort();
+			}
+		}
+	}
+
+	for (size_t offset = 12; offset < size; offset++) {
+		char name[256];
+		size_t cursor = offset;
+		if (isr_view_name(packet, size, &cursor, name) && (cursor > size || strlen(name) > 253)) abort();
+	}
+
+	free(packet);
+
+	return 0;
+}
+
+#ifdef ISR_FUZZ_MAIN
+int isr_fuzz_file(FILE *file) {
+	unsigned char *data = malloc(ISR_FUZZ_SIZE);
+	size_t size = fread(data, 1, ISR_FUZZ_SIZE, file);
+
+	LLVMFuzzerTestOneInput(data, size);
+
+	free(data);
+	return 0;
+}
+
+int main(int argc, char *argv[]) {
+	if (argc < 2) return isr_fuzz_file(stdin);
+
+	for (int i = 1; i < argc; i++) {
+		FILE *file = fopen(argv[i], "rb");
+		if (file == NULL) {
+			perror(argv[i]);
+			return 1;
+		}
+
+		isr_fuzz_file(file);
+		fclose(file);
+	}
+
+	return 0;
+}
+#endif
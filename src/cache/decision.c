@@ -0,0 +1,186 @@
+/*
+		Copyright (C) 2023
+			Pribess (Heewon Cho)
+			Jhyub	(Janghyub Seo)
+		src/cache/decision.c
+*/
+
+#include "decision.h"
+
+extern struct config isr_config;
+
+/*
+	Memoizes what resolve() decided for a (qname, qtype), not the final answer.
+	An entry stays valid until its hinted ttl runs out or one of the state
+	providers it depends on reports different data (see isr_script_state_refresh),
+	so a query that hits here never enters the script at all.
+*/
+
+#define ISR_DECISION_BUCKETS 1024
+
+struct decision *decisions[ISR_DECISION_BUCKETS];
+size_t decisions_size = 0;
+
+/*
+	"network.ssid" depends on a provider registered as "network" and vice versa,
+	since either one changing may change what resolve() sees.
+*/
+bool isr_decision_path_overlaps(const char *depends, struct state_provider *provider) {
+	const char *cursor = depends;
+
+	for (size_t i = 0; i < provider->path_length; i++) {
+		size_t length = strlen(provider->path[i]);
+		if (strncmp(cursor, provider->path[i], length) != 0) return false;
+
+		cursor += length;
+		if (*cursor == '\0') return true;
+		if (*cursor != '.') return false;
+		cursor++;
+	}
+
+	return true;
+}
+
+void isr_decision_free(struct decision *decision) {
+	isr_name_release(decision->name);
+	free(decision->dependencies);
+	isr_resolve_result_free(decision->result);
+	free(decision);
+}
+
+bool isr_decision_valid(struct decision *decision, uint64_t now) {
+	if (now >= decision->expire) return false;
+
+	if (decision->depends_all) return decision->state_version == isr_script_state_version;
+
+	for (size_t i = 0; i < decision->dependencies_length; i++) {
+		struct decision_dependency *dependency = &decision->dependencies[i];
+		if (dependency->provider->version != dependency->version) return false;
+	}
+
+	return true;
+}
+
+struct resolve_result *isr_decision_lookup(struct question *question) {
+	struct name *name = question->name != NULL ? question->name : isr_name_find(question->qname);
+	if (name == NULL) return NULL;
+
+	uint32_t hash = isr_name_key(name, question->qtype);
+	uint64_t now = isr_clock_ms();
+
+	struct decision **link = &decisions[hash % ISR_DECISION_BUCKETS];
+	while (*link != NULL) {
+		struct decision *decision = *link;
+
+		if (decision->name == name && decision->qtype == question->qtype && isr_subnet_covers(&decision->scope, question->subnet)) {
+			if (isr_decision_valid(decision, now)) return isr_resolve_result_copy(decision->result);
+
+			*link = decision->next;
+			isr_decision_free(decision);
+			decisions_size--;
+			continue;
+		}
+
+		link = &decision->next;
+	}
+
+	return NULL;
+}
+
+void isr_decision_store(struct question *question, struct resolve_result *result, struct state_provider **providers, size_t providers_size) {
+	if (result->hint == NULL || result->hint->ttl == 0) return;
+	if (result->hint->scope > 0 && (!isr_config.scoped_cache || question->subnet == NULL)) return;
+
+	struct name *name = question->name != NULL ? isr_name_retain(question->name) : isr_name_intern(question->qname);
+	if (name == NULL) return;
+
+	/* Decisions are cheap to recompute, so a full table is simply started over */
+	if (decisions_size >= isr_config.decision_cache_size) isr_decision_flush();
+
+	struct decision *decision = malloc(sizeof(struct decision));
+	decision->name = name;
+	decision->qtype = question->qtype;
+	decision->hash = isr_name_key(name, question->qtype);
+	decision->expire = isr_clock_ms() + (uint64_t) result->hint->ttl * 1000;
+	decision->depends_all = result->hint->depends == NULL;
+	decision->state_version = isr_script_state_version;
+	decision->dependencies = NULL;
+	decision->dependencies_length = 0;
+	decision->result = isr_resolve_result_copy(result);
+	isr_subnet_scope(&decision->scope, question->subnet, result->hint->scope);
+
+	if (!decision->depends_all) {
+		decision->dependencies = malloc((providers_size + 1) * sizeof(struct decision_dependency));
+
+		for (size_t i = 0; i < providers_size; i++) {
+			struct state_provider *provider = providers[i];
+			if (!provider->is_first) continue;
+
+			for (size_t j = 0; j < result->hint->depends_length; j++) {
+				if (!isr_decision_path_overlaps(result->hint->depends[j], provider)) continue;
+
+				decision->dependencies[decision->dependencies_length].provider = provider;
+				decision->dependencies[decision->dependencies_length].version = provider->version;
+				decision->dependencies_length++;
+				break;
+			}
+		}
+	}
+
+	struct decision **bucket = &decisions[decision->hash % ISR_DECISION_BUCKETS];
+	decision->next = *bucket;
+	*bucket = decision;
+	decisions_size++;
+}
+
+/*
+	Drops every decision for qname, or for qname and everything below it when subtree is set.
+*/
+size_t isr_decision_invalidate(const char *qname, bool subtree) {
+	size_t ret = 0;
+
+	struct name *zone = isr_name_find(qname);
+	if (zone == NULL) return 0;
+
+	/* Held so that dropping the last entry of zone itself can't free it under us */
+	isr_name_retain(zone);
+
+	for (size_t i = 0; i < ISR_DECISION_BUCKETS; i++) {
+		struct decision **link = &decisions[i];
+		while (*link != NULL) {
+			struct decision *decision = *link;
+
+			if (subtree ? isr_name_under(decision->name, zone) : decision->name == zone) {
+				*link = decision->next;
+				isr_decision_free(decision);
+				decisions_size--;
+				ret++;
+				continue;
+			}
+
+			link = &decision->next;
+		}
+	}
+
+	isr_name_release(zone);
+
+	return ret;
+}
+
+size_t isr_decision_count() {
+	return decisions_size;
+}
+
+void isr_decision_flush() {
+	for (size_t i = 0; i < ISR_DECISION_BUCKETS; i++) {
+		struct decision *decision = decisions[i];
+		while (decision != NULL) {
+			struct decision *next = decision->next;
+			isr_decision_free(decision);
+			decision = next;
+		}
+		decisions[i] = NULL;
+	}
+
+	decisions_size = 0;
+}
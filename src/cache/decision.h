@@ -0,0 +1,52 @@
+/*
+		Copyright (C) 2023
+			Pribess (Heewon Cho)
+			Jhyub	(Janghyub Seo)
+		src/cache/decision.h
+*/
+
+#ifndef ISR_CACHE_DECISION
+#define ISR_CACHE_DECISION
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../clock.h"
+#include "../config.h"
+#include "../packet/question.h"
+#include "name.h"
+#include "../script/engine.h"
+#include "../script/state.h"
+
+struct decision_dependency {
+	struct state_provider *provider;
+	uint32_t version;
+};
+
+struct decision {
+	struct name *name;
+	uint16_t qtype;
+	uint32_t hash;
+	uint64_t expire;
+	bool depends_all;
+	uint32_t state_version; /* only checked when depends_all */
+	struct decision_dependency *dependencies;
+	size_t dependencies_length;
+	struct client_subnet scope; /* clients the decision was made for, prefix 0 meaning everyone */
+	struct resolve_result *result;
+	struct decision *next;
+};
+
+struct resolve_result *isr_decision_lookup(struct question *question);
+
+void isr_decision_store(struct question *question, struct resolve_result *result, struct state_provider **providers, size_t providers_size);
+
+size_t isr_decision_invalidate(const char *qname, bool subtree);
+
+size_t isr_decision_count();
+
+void isr_decision_flush();
+
+#endif
@@ -0,0 +1,217 @@
+/*
+		Copyright (C) 2023
+			Pribess (Heewon Cho)
+			Jhyub	(Janghyub Seo)
+		src/cache/name.c
+*/
+
+#include "name.h"
+
+/*
+	Every node holds a reference on its parent, and whoever keeps a name
+	(a cache entry, say) holds one on the name itself.
+	Nodes are freed, from the leaf up, as soon as nothing refers to them.
+*/
+
+struct name isr_name_root = { .parent = NULL, .next = NULL, .hash = ISR_LABEL_ROOT, .refs = 1, .length = 0 };
+
+struct name **names = NULL;
+size_t names_capacity = 0;
+struct name_stats names_stats;
+
+void isr_name_grow() {
+	size_t capacity = names_capacity == 0 ? 1024 : names_capacity * 2;
+	struct name **grown = calloc(capacity, sizeof(struct name *));
+
+	for (size_t i = 0; i < names_capacity; i++) {
+		struct name *name = names[i];
+		while (name != NULL) {
+			struct name *next = name->next;
+			name->next = grown[name->hash & (capacity - 1)];
+			grown[name->hash & (capacity - 1)] = name;
+			name = next;
+		}
+	}
+
+	free(names);
+	names = grown;
+	names_capacity = capacity;
+}
+
+/*
+	label is already lowercased and label_hash is its isr_label_fold hash.
+*/
+struct name *isr_name_child(struct name *parent, const unsigned char *label, size_t length, uint32_t label_hash, bool create) {
+	uint32_t hash = isr_label_chain(parent->hash, label_hash);
+
+	if (names_capacity > 0) {
+		for (struct name *name = names[hash & (names_capacity - 1)]; name != NULL; name = name->next) {
+			if (name->hash == hash && name->parent == parent && name->length == length && memcmp(name->label, label, length) == 0) return name;
+		}
+	}
+
+	if (!create) return NULL;
+
+	if (names_stats.nodes >= names_capacity) isr_name_grow();
+
+	struct name *ret = malloc(sizeof(struct name) + length);
+	ret->parent = isr_name_retain(parent);
+	ret->hash = hash;
+	ret->refs = 0;
+	ret->length = length;
+	memcpy(ret->label, label, length);
+
+	ret->next = names[hash & (names_capacity - 1)];
+	names[hash & (names_capacity - 1)] = ret;
+
+	names_stats.nodes++;
+	names_stats.bytes += sizeof(struct name) + length;
+
+	return ret;
+}
+
+bool isr_name_valid(const char *qname, size_t length) {
+	size_t label = 0;
+
+	for (size_t i = 0; i < length; i++) {
+		if (qname[i] != '.') {
+			if (++label > 63) return false;
+			continue;
+		}
+		if (label == 0) return false;
+		label = 0;
+	}
+
+	return true;
+}
+
+/*
+	Walks qname from its rightmost label, "www.example.com." and "www.example.com" being the same name.
+*/
+struct name *isr_name_walk(const char *qname, bool create) {
+	size_t end = strlen(qname);
+	if (end > 0 && qname[end - 1] == '.') end--;
+
+	if (!isr_name_valid(qname, end)) return NULL;
+
+	size_t readable = strlen(qname);
+	unsigned char lower[63 + ISR_LABEL_SLACK];
+
+	struct name *ret = &isr_name_root;
+	while (end > 0) {
+		size_t start = end;
+		while (start > 0 && qname[start - 1] != '.') start--;
+
+		uint32_t label_hash = isr_label_fold((const unsigned char *) qname + start, end - start, readable - start, lower);
+		ret = isr_name_child(ret, lower, end - start, label_hash, create);
+		if (ret == NULL) return NULL;
+
+		end = start == 0 ? 0 : start - 1;
+	}
+
+	return ret;
+}
+
+/*
+	Same walk over a name isr_view_parse already folded, touching only its labels' hashes.
+*/
+struct name *isr_name_walk_wire(const unsigned char *lower, const uint8_t *labels, const uint32_t *label_hashes, size_t labels_length, bool create) {
+	struct name *ret = &isr_name_root;
+
+	for (size_t i = labels_length; i > 0; i--) {
+		const unsigned char *label = lower + labels[i - 1];
+
+		ret = isr_name_child(ret, label + 1, label[0], label_hashes[i - 1], create);
+		if (ret == NULL) return NULL;
+	}
+
+	return ret;
+}
+
+/*
+	Returns qname interned with a reference taken, NULL if qname is not a valid name.
+*/
+struct name *isr_name_intern(const char *qname) {
+	struct name *ret = isr_name_walk(qname, true);
+	if (ret == NULL) return NULL;
+
+	return isr_name_retain(ret);
+}
+
+/*
+	Returns qname if it is interned right now, without taking a reference.
+	Nothing can be cached under a name that was never interned, so lookups use this
+	and never allocate.
+*/
+struct name *isr_name_find(const char *qname) {
+	return isr_name_walk(qname, false);
+}
+
+struct name *isr_name_find_wire(const unsigned char *lower, const uint8_t *labels, const uint32_t *label_hashes, size_t labels_length) {
+	return isr_name_walk_wire(lower, labels, label_hashes, labels_length, false);
+}
+
+struct name *isr_name_retain(struct name *name) {
+	name->refs++;
+	return name;
+}
+
+void isr_name_release(struct name *name) {
+	while (name != &isr_name_root && --name->refs == 0) {
+		struct name *parent = name->parent;
+
+		struct name **link = &names[name->hash & (names_capacity - 1)];
+		while (*link != name) link = &(*link)->next;
+		*link = name->next;
+
+		names_stats.nodes--;
+		names_stats.bytes -= sizeof(struct name) + name->length;
+		free(name);
+
+		name = parent;
+	}
+}
+
+/*
+	Hash for tables keyed on (name, type), e.g. the caches.
+*/
+uint32_t isr_name_key(struct name *name, uint16_t type) {
+	return (name->hash ^ type) * 16777619u;
+}
+
+/*
+	Whether name is zone itself or a subdomain of it.
+*/
+bool isr_name_under(struct name *name, struct name *zone) {
+	for (struct name *cursor = name; cursor != NULL; cursor = cursor->parent) {
+		if (cursor == zone) return true;
+	}
+
+	return false;
+}
+
+/*
+	Writes the dotted form of name, without a trailing dot, into buff.
+	Returns the length it needed, which may be larger than size.
+*/
+size_t isr_name_format(struct name *name, char *buff, size_t size) {
+	size_t ret = 0;
+
+	for (struct name *cursor = name; cursor != &isr_name_root; cursor = cursor->parent) {
+		if (cursor != name) {
+			if (ret < size) buff[ret] = '.';
+			ret++;
+		}
+		for (size_t i = 0; i < cursor->length; i++, ret++) {
+			if (ret < size) buff[ret] = cursor->label[i];
+		}
+	}
+
+	if (size > 0) buff[ret < size ? ret : size - 1] = '\0';
+
+	return ret;
+}
+
+void isr_name_stats(struct name_stats *stats) {
+	*stats = names_stats;
+}
@@ -0,0 +1,55 @@
+/*
+		Copyright (C) 2023
+			Pribess (Heewon Cho)
+			Jhyub	(Janghyub Seo)
+		src/cache/name.h
+*/
+
+#ifndef ISR_CACHE_NAME
+#define ISR_CACHE_NAME
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../packet/label.h"
+
+/*
+	One label of an interned name, pointing to the name it is a subdomain of.
+	"a.corp.example.com" and "b.corp.example.com" share the
+	"corp" -> "example" -> "com" nodes, and equal names are the same node.
+*/
+struct name {
+	struct name *parent;
+	struct name *next; /* intern table chain */
+	uint32_t hash; /* of the whole name, case-insensitive, see isr_label_chain */
+	uint32_t refs;
+	uint8_t length;
+	char label[]; /* lowercased, not terminated */
+};
+
+struct name_stats {
+	size_t nodes;
+	size_t bytes;
+};
+
+struct name *isr_name_intern(const char *qname);
+
+struct name *isr_name_find(const char *qname);
+
+struct name *isr_name_find_wire(const unsigned char *lower, const uint8_t *labels, const uint32_t *label_hashes, size_t labels_length);
+
+struct name *isr_name_retain(struct name *name);
+
+void isr_name_release(struct name *name);
+
+uint32_t isr_name_key(struct name *name, uint16_t type);
+
+bool isr_name_under(struct name *name, struct name *zone);
+
+size_t isr_name_format(struct name *name, char *buff, size_t size);
+
+void isr_name_stats(struct name_stats *stats);
+
+#endif
@@ -0,0 +1,421 @@
+/*
+		Copyright (C) 2023
+			Pribess (Heewon Cho)
+			Jhyub	(Janghyub Seo)
+		src/cache/response.c
+*/
+
+#include "response.h"
+
+extern struct config isr_config;
+
+/*
+	Entries are bounded by isr_config.response_cache_bytes and evicted with S3-FIFO:
+	new entries land in a small FIFO (a tenth of the budget) and only the ones hit
+	again while there are promoted to the main FIFO. Entries evicted from the small
+	FIFO leave their hash in a ghost queue, so they go straight to main if they come back.
+	A burst of one-off names (random subdomains) therefore only churns the small FIFO.
+	Hits just bump a 2 bit counter, no list is touched on the read path.
+*/
+
+#define ISR_RESPONSE_BUCKETS 4096
+#define ISR_RESPONSE_FREQ_MAX 3
+#define ISR_RESPONSE_GHOST_SLOTS 4096
+
+struct response_queue {
+	struct cached_response *head; /* newest */
+	struct cached_response *tail; /* oldest */
+	size_t bytes;
+};
+
+struct cached_response *responses[ISR_RESPONSE_BUCKETS];
+struct response_queue responses_small;
+struct response_queue responses_main;
+struct response_cache_stats responses_stats;
+
+/*
+	Ghost queue: a ring of recently evicted hashes plus a counting filter for membership.
+	False positives only mean an entry skips the small FIFO.
+*/
+uint32_t *responses_ghost = NULL;
+size_t responses_ghost_capacity = 0;
+size_t responses_ghost_start = 0;
+size_t responses_ghost_length = 0;
+uint8_t responses_ghost_filter[ISR_RESPONSE_GHOST_SLOTS];
+
+void isr_response_ghost_push(uint32_t hash) {
+	if (responses_ghost == NULL) {
+		responses_ghost_capacity = isr_config.response_cache_bytes / 128 + 64;
+		responses_ghost = malloc(responses_ghost_capacity * sizeof(uint32_t));
+	}
+
+	if (responses_ghost_length == responses_ghost_capacity) {
+		uint32_t oldest = responses_ghost[responses_ghost_start];
+		responses_ghost_filter[oldest % ISR_RESPONSE_GHOST_SLOTS]--;
+		responses_ghost_start = (responses_ghost_start + 1) % responses_ghost_capacity;
+		responses_ghost_length--;
+	}
+
+	uint8_t *slot = &responses_ghost_filter[hash % ISR_RESPONSE_GHOST_SLOTS];
+	if (*slot == UINT8_MAX) return;
+	(*slot)++;
+
+	responses_ghost[(responses_ghost_start + responses_ghost_length) % responses_ghost_capacity] = hash;
+	responses_ghost_length++;
+}
+
+bool isr_response_ghost_has(uint32_t hash) {
+	return responses_ghost_filter[hash % ISR_RESPONSE_GHOST_SLOTS] > 0;
+}
+
+void isr_response_queue_push(struct response_queue *queue, struct cached_response *cached) {
+	cached->queue_prev = NULL;
+	cached->queue_next = queue->head;
+	if (queue->head != NULL) queue->head->queue_prev = cached;
+	queue->head = cached;
+	if (queue->tail == NULL) queue->tail = cached;
+	queue->bytes += cached->charge;
+}
+
+void isr_response_queue_remove(struct response_queue *queue, struct cached_response *cached) {
+	if (cached->queue_prev != NULL) cached->queue_prev->queue_next = cached->queue_next;
+	else queue->head = cached->queue_next;
+
+	if (cached->queue_next != NULL) cached->queue_next->queue_prev = cached->queue_prev;
+	else queue->tail = cached->queue_prev;
+
+	queue->bytes -= cached->charge;
+}
+
+void isr_response_cache_free(struct cached_response *cached) {
+	isr_name_release(cached->name);
+	free(cached->wire);
+	free(cached->ttl_offsets);
+	free(cached->ttls);
+	free(cached);
+}
+
+void isr_response_cache_unlink(struct cached_response *cached) {
+	struct cached_response **link = &responses[cached->hash % ISR_RESPONSE_BUCKETS];
+	while (*link != cached) link = &(*link)->next;
+	*link = cached->next;
+
+	isr_response_queue_remove(cached->in_main ? &responses_main : &responses_small, cached);
+
+	responses_stats.entries--;
+	responses_stats.bytes -= cached->charge;
+}
+
+void isr_response_cache_evict(struct cached_response *cached) {
+	isr_response_cache_unlink(cached);
+	isr_response_cache_free(cached);
+	responses_stats.evictions++;
+}
+
+void isr_response_cache_evict_main(uint64_t now) {
+	while (responses_main.tail != NULL) {
+		struct cached_response *cached = responses_main.tail;
+
+		if (cached->freq > 0 && now < cached->expire) {
+			cached->freq--;
+			isr_response_queue_remove(&responses_main, cached);
+			isr_response_queue_push(&responses_main, cached);
+			continue;
+		}
+
+		isr_response_cache_evict(cached);
+		return;
+	}
+}
+
+void isr_response_cache_evict_small(uint64_t now) {
+	while (responses_small.tail != NULL) {
+		struct cached_response *cached = responses_small.tail;
+
+		if (cached->freq > 0 && now < cached->expire) {
+			cached->freq = 0;
+			cached->in_main = true;
+			isr_response_queue_remove(&responses_small, cached);
+			isr_response_queue_push(&responses_main, cached);
+
+			if (responses_main.bytes > isr_config.response_cache_bytes - isr_config.response_cache_bytes / 10) {
+				isr_response_cache_evict_main(now);
+			}
+			continue;
+		}
+
+		isr_response_ghost_push(cached->hash);
+		isr_response_cache_evict(cached);
+		return;
+	}
+}
+
+void isr_response_cache_make_room(size_t charge, uint64_t now) {
+	while (responses_stats.bytes + charge > isr_config.response_cache_bytes) {
+		if (responses_small.bytes > isr_config.response_cache_bytes / 10 || responses_main.tail == NULL) {
+			isr_response_cache_evict_small(now);
+		} else {
+			isr_response_cache_evict_main(now);
+		}
+	}
+}
+
+/*
+	With exact, only an entry given for exactly scope is found,
+	otherwise any entry whose scope covers it (the asking client) is.
+*/
+struct cached_response *isr_response_cache_find(struct name *name, uint16_t qtype, uint16_t qclass, uint32_t hash, struct client_subnet *scope, bool exact) {
+	for (struct cached_response *cached = responses[hash % ISR_RESPONSE_BUCKETS]; cached != NULL; cached = cached->next) {
+		if (cached->name != name || cached->qtype != qtype || cached->qclass != qclass) continue;
+
+		if (exact) {
+			if (cached->scope.prefix == scope->prefix && (scope->prefix == 0 || isr_subnet_covers(&cached->scope, scope))) return cached;
+		} else if (isr_subnet_covers(&cached->scope, scope)) {
+			return cached;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+	Returns the live entry for question without counting it as a hit.
+*/
+struct cached_response *isr_response_cache_peek(struct question *question) {
+	struct name *name = question->name != NULL ? question->name : isr_name_find(question->qname);
+	if (name == NULL) return NULL;
+
+	struct cached_response *cached = isr_response_cache_find(name, question->qtype, question->qclass, isr_name_key(name, question->qtype), question->subnet, false);
+	if (cached == NULL) return NULL;
+
+	if (isr_clock_ms() >= cached->expire) {
+		isr_response_cache_evict(cached);
+		return NULL;
+	}
+
+	return cached;
+}
+
+struct cached_response *isr_response_cache_lookup(struct question *question) {
+	struct cached_response *cached = isr_response_cache_peek(question);
+
+	if (cached == NULL) {
+		responses_stats.misses++;
+		return NULL;
+	}
+
+	if (cached->freq < ISR_RESPONSE_FREQ_MAX) cached->freq++;
+	responses_stats.hits++;
+
+	return cached;
+}
+
+uint32_t isr_response_cache_ttl(struct cached_response *cached) {
+	return (cached->expire - isr_clock_ms()) / 1000;
+}
+
+/*
+	Copies the stored response with its TTLs decremented by the time spent in the cache.
+*/
+size_t isr_response_cache_copy(struct cached_response *cached, unsigned char *resp, size_t resp_size) {
+	if (cached->length > resp_size) return 0;
+
+	memcpy(resp, cached->wire, cached->length);
+
+	uint32_t elapsed = (isr_clock_ms() - cached->stored) / 1000;
+	for (size_t i = 0; i < cached->ttls_length; i++) {
+		*(uint32_t *)(resp + cached->ttl_offsets[i]) = htonl(cached->ttls[i] - elapsed);
+	}
+
+	return cached->length;
+}
+
+/*
+	Serving is a copy of the stored response plus patching what differs per query:
+	the ID, the RD bit and the question (to echo the client's 0x20 casing).
+*/
+size_t isr_response_cache_serve(struct cached_response *cached, unsigned char *req, unsigned char *resp, size_t resp_size) {
+	size_t ret = isr_response_cache_copy(cached, resp, resp_size);
+	if (ret == 0) return 0;
+
+	memcpy(resp, req, 2);
+	resp[2] = (resp[2] & 0xFE) | (req[2] & 0x01);
+	memcpy(resp + 12, req + 12, cached->question_length);
+
+	return ret;
+}
+
+/*
+	Takes ownership of wire, which must start with a header and the single question.
+	A scope other than 0 keeps the entry to clients sharing that many bits of question->subnet.
+	The entry expires with its shortest TTL.
+	Returns NULL (wire untouched) if the response can't fit in the budget at all.
+*/
+struct cached_response *isr_response_cache_store(struct question *question, uint8_t scope, unsigned char *wire, size_t length, size_t question_length, uint16_t *ttl_offsets, size_t ttl_offsets_length) {
+	if (scope > 0 && (!isr_config.scoped_cache || question->subnet == NULL)) return NULL;
+
+	struct name *name = question->name != NULL ? isr_name_retain(question->name) : isr_name_intern(question->qname);
+	if (name == NULL) return NULL;
+
+	/* Suffixes are shared between entries, only the leaf label is charged to this one */
+	size_t charge = sizeof(struct cached_response)
+		+ sizeof(struct name) + name->length
+		+ length
+		+ ttl_offsets_length * (sizeof(uint16_t) + sizeof(uint32_t));
+
+	if (charge > isr_config.response_cache_bytes / 10) {
+		isr_name_release(name);
+		return NULL;
+	}
+
+	uint64_t now = isr_clock_ms();
+
+	struct client_subnet subnet;
+	isr_subnet_scope(&subnet, question->subnet, scope);
+
+	uint32_t hash = isr_name_key(name, question->qtype);
+	struct cached_response *stale = isr_response_cache_find(name, question->qtype, question->qclass, hash, &subnet, true);
+	if (stale != NULL) isr_response_cache_evict(stale);
+
+	isr_response_cache_make_room(charge, now);
+
+	struct cached_response *cached = malloc(sizeof(struct cached_response));
+	cached->name = name;
+	cached->qtype = question->qtype;
+	cached->qclass = question->qclass;
+	cached->hash = hash;
+	cached->wire = wire;
+	cached->length = length;
+	cached->question_length = question_length;
+	cached->scope = subnet;
+	cached->ttl_offsets = malloc(ttl_offsets_length * sizeof(uint16_t));
+	cached->ttls = malloc(ttl_offsets_length * sizeof(uint32_t));
+	cached->ttls_length = ttl_offsets_length;
+	cached->stored = now;
+	cached->charge = charge;
+	cached->freq = 0;
+
+	uint32_t min_ttl = ttl_offsets_length == 0 ? 0 : UINT32_MAX;
+	for (size_t i = 0; i < ttl_offsets_length; i++) {
+		cached->ttl_offsets[i] = ttl_offsets[i];
+		cached->ttls[i] = ntohl(*(uint32_t *)(wire + ttl_offsets[i]));
+		if (cached->ttls[i] < min_ttl) min_ttl = cached->ttls[i];
+	}
+
+	cached->expire = now + (uint64_t) min_ttl * 1000;
+
+	struct cached_response **bucket = &responses[hash % ISR_RESPONSE_BUCKETS];
+	cached->next = *bucket;
+	*bucket = cached;
+
+	cached->in_main = isr_response_ghost_has(hash);
+	isr_response_queue_push(cached->in_main ? &responses_main : &responses_small, cached);
+
+	responses_stats.entries++;
+	responses_stats.bytes += charge;
+
+	return cached;
+}
+
+/*
+	Caches a single record answer, as if a script had answered it.
+*/
+bool isr_response_cache_put(const char *qname, uint16_t qtype, uint32_t ttl, unsigned char *rdata, uint16_t rdlength) {
+	if (ttl == 0) return false;
+
+	struct header header = {
+		.id = 0,
+		.qr = 1,
+		.opcode = 0,
+		.aa = 0,
+		.tc = 0,
+		.rd = 1,
+		.ra = 1,
+		.z = 0,
+		.rcode = 0,
+		.qdcount = 0,
+		.ancount = 0,
+		.nscount = 0,
+		.arcount = 0,
+	};
+
+	struct question question = {
+		.qname = (char *) qname,
+		.qtype = qtype,
+		.qclass = 1,
+	};
+
+	struct record record = {
+		.type = qtype,
+		.class = 1,
+		.ttl = ttl,
+		.rdlength = rdlength,
+		.rdata = rdata,
+	};
+
+	size_t size = 12 + 256 + 4 + 12 + rdlength;
+	unsigned char *wire = malloc(size * sizeof(unsigned char));
+
+	struct packet_writer writer;
+	isr_writer_init(&writer, wire, size);
+	isr_writer_header(&writer, &header);
+	isr_writer_question(&writer, &question);
+
+	/* The record may come out shorter than rdlength once the names in its RDATA are compressed */
+	size_t question_length = writer.length - 12;
+	isr_writer_record(&writer, ANSWER_SECTION, &record);
+
+	size_t length = isr_writer_finish(&writer);
+
+	if (writer.truncated || writer.invalid || isr_response_cache_store(&question, 0, wire, length, question_length, writer.ttl_offsets, writer.ttl_offsets_length) == NULL) {
+		free(wire);
+		return false;
+	}
+
+	return true;
+}
+
+/*
+	Drops every entry for qname, or for qname and everything below it when subtree is set.
+	Returns how many entries were dropped.
+*/
+size_t isr_response_cache_invalidate(const char *qname, bool subtree) {
+	size_t ret = 0;
+
+	struct name *zone = isr_name_find(qname);
+	if (zone == NULL) return 0;
+
+	/* Held so that dropping the last entry of zone itself can't free it under us */
+	isr_name_retain(zone);
+
+	struct response_queue *queues[] = { &responses_small, &responses_main };
+	for (size_t i = 0; i < 2; i++) {
+		struct cached_response *cached = queues[i]->head;
+		while (cached != NULL) {
+			struct cached_response *next = cached->queue_next;
+
+			if (subtree ? isr_name_under(cached->name, zone) : cached->name == zone) {
+				isr_response_cache_unlink(cached);
+				isr_response_cache_free(cached);
+				ret++;
+			}
+
+			cached = next;
+		}
+	}
+
+	isr_name_release(zone);
+
+	return ret;
+}
+
+void isr_response_cache_stats(struct response_cache_stats *stats) {
+	*stats = responses_stats;
+	stats->small_bytes = responses_small.bytes;
+	stats->main_bytes = responses_main.bytes;
+}
+
+void isr_response_cache_flush() {
+	while (responses_small.tail != NULL) isr_response_cache_evict(responses_small.tail);
+	while (responses_main.tail != NULL) isr_response_cache_evict(responses_main.tail);
+}
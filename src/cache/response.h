@@ -0,0 +1,80 @@
+/*
+		Copyright (C) 2023
+			Pribess (Heewon Cho)
+			Jhyub	(Janghyub Seo)
+		src/cache/response.h
+*/
+
+#ifndef ISR_CACHE_RESPONSE
+#define ISR_CACHE_RESPONSE
+
+#include <arpa/inet.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../clock.h"
+#include "../config.h"
+#include "../packet/question.h"
+#include "../packet/writer.h"
+#include "name.h"
+
+/*
+	A complete response in wire format.
+	The ID always lives at offset 0 and the question right after the 12 byte header,
+	so only the TTL fields need their offsets recorded.
+*/
+struct cached_response {
+	struct name *name;
+	uint16_t qtype;
+	uint16_t qclass;
+	uint32_t hash;
+	unsigned char *wire;
+	size_t length;
+	size_t question_length;
+	struct client_subnet scope; /* clients the response was given for, prefix 0 meaning everyone */
+	uint16_t *ttl_offsets;
+	uint32_t *ttls;
+	size_t ttls_length;
+	uint64_t stored;
+	uint64_t expire;
+	size_t charge; /* bytes accounted against isr_config.response_cache_bytes */
+	uint8_t freq;
+	bool in_main;
+	struct cached_response *next; /* bucket chain */
+	struct cached_response *queue_prev;
+	struct cached_response *queue_next;
+};
+
+struct response_cache_stats {
+	size_t entries;
+	size_t bytes;
+	size_t small_bytes;
+	size_t main_bytes;
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t evictions;
+};
+
+struct cached_response *isr_response_cache_peek(struct question *question);
+
+struct cached_response *isr_response_cache_lookup(struct question *question);
+
+uint32_t isr_response_cache_ttl(struct cached_response *cached);
+
+size_t isr_response_cache_copy(struct cached_response *cached, unsigned char *resp, size_t resp_size);
+
+size_t isr_response_cache_serve(struct cached_response *cached, unsigned char *req, unsigned char *resp, size_t resp_size);
+
+struct cached_response *isr_response_cache_store(struct question *question, uint8_t scope, unsigned char *wire, size_t length, size_t question_length, uint16_t *ttl_offsets, size_t ttl_offsets_length);
+
+bool isr_response_cache_put(const char *qname, uint16_t qtype, uint32_t ttl, unsigned char *rdata, uint16_t rdlength);
+
+size_t isr_response_cache_invalidate(const char *qname, bool subtree);
+
+void isr_response_cache_stats(struct response_cache_stats *stats);
+
+void isr_response_cache_flush();
+
+#endif
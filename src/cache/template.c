@@ -0,0 +1,100 @@
+/*
+		Copyright (C) 2023
+			Pribess (Heewon Cho)
+			Jhyub	(Janghyub Seo)
+		src/cache/template.c
+*/
+
+#include "template.h"
+
+#define ISR_TEMPLATE_BUCKETS 256
+
+struct response_template *templates[ISR_TEMPLATE_BUCKETS];
+size_t templates_size = 0;
+
+struct response_template *isr_template_lookup(struct question *question) {
+	if (templates_size == 0) return NULL;
+
+	struct name *name = question->name != NULL ? question->name : isr_name_find(question->qname);
+	if (name == NULL) return NULL;
+
+	uint32_t hash = isr_name_key(name, question->qtype);
+	for (struct response_template *template = templates[hash % ISR_TEMPLATE_BUCKETS]; template != NULL; template = template->next) {
+		if (template->name == name && template->qtype == question->qtype && template->qclass == question->qclass) return template;
+	}
+
+	return NULL;
+}
+
+/*
+	Copies template to resp with the ID, RD bit and question (in the client's case) of req.
+	Returns 0 if it doesn't fit in resp_size.
+*/
+size_t isr_template_serve(struct response_template *template, unsigned char *req, unsigned char *resp, size_t resp_size) {
+	if (template->length > resp_size) return 0;
+
+	memcpy(resp, template->wire, template->length);
+	memcpy(resp, req, 2);
+	resp[2] = (resp[2] & 0xFE) | (req[2] & 0x01);
+	memcpy(resp + 12, req + 12, template->question_length);
+
+	return template->length;
+}
+
+/*
+	wire must start with a header and the single question, and is copied.
+	A template already there for the same question is replaced.
+*/
+bool isr_template_store(struct question *question, unsigned char *wire, size_t length, size_t question_length) {
+	struct name *name = question->name != NULL ? isr_name_retain(question->name) : isr_name_intern(question->qname);
+	if (name == NULL) return false;
+
+	uint32_t hash = isr_name_key(name, question->qtype);
+	struct response_template **link = &templates[hash % ISR_TEMPLATE_BUCKETS];
+	while (*link != NULL) {
+		struct response_template *stale = *link;
+
+		if (stale->name == name && stale->qtype == question->qtype && stale->qclass == question->qclass) {
+			*link = stale->next;
+			isr_name_release(stale->name);
+			free(stale);
+			templates_size--;
+			break;
+		}
+
+		link = &stale->next;
+	}
+
+	struct response_template *template = malloc(sizeof(struct response_template) + length);
+	template->name = name;
+	template->qtype = question->qtype;
+	template->qclass = question->qclass;
+	template->hash = hash;
+	template->length = length;
+	template->question_length = question_length;
+	memcpy(template->wire, wire, length);
+
+	template->next = templates[hash % ISR_TEMPLATE_BUCKETS];
+	templates[hash % ISR_TEMPLATE_BUCKETS] = template;
+	templates_size++;
+
+	return true;
+}
+
+size_t isr_template_count() {
+	return templates_size;
+}
+
+void isr_template_flush() {
+	for (size_t i = 0; i < ISR_TEMPLATE_BUCKETS; i++) {
+		while (templates[i] != NULL) {
+			struct response_template *template = templates[i];
+			templates[i] = template->next;
+
+			isr_name_release(template->name);
+			free(template);
+		}
+	}
+
+	templates_size = 0;
+}
@@ -0,0 +1,44 @@
+/*
+		Copyright (C) 2023
+			Pribess (Heewon Cho)
+			Jhyub	(Janghyub Seo)
+		src/cache/template.h
+*/
+
+#ifndef ISR_CACHE_TEMPLATE
+#define ISR_CACHE_TEMPLATE
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../packet/question.h"
+#include "name.h"
+
+/*
+	A response compiled once from a static answer of isr.js.
+	Unlike a cached response it never ages, it only goes away when the scripts are reloaded.
+*/
+struct response_template {
+	struct name *name;
+	uint16_t qtype;
+	uint16_t qclass;
+	uint32_t hash;
+	size_t length;
+	size_t question_length;
+	struct response_template *next;
+	unsigned char wire[];
+};
+
+struct response_template *isr_template_lookup(struct question *question);
+
+size_t isr_template_serve(struct response_template *template, unsigned char *req, unsigned char *resp, size_t resp_size);
+
+bool isr_template_store(struct question *question, unsigned char *wire, size_t length, size_t question_length);
+
+size_t isr_template_count();
+
+void isr_template_flush();
+
+#endif
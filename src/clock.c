@@ -0,0 +1,19 @@
+/*
+		Copyright (C) 2023
+			Pribess (Heewon Cho)
+			Jhyub	(Janghyub Seo)
+		src/clock.c
+*/
+
+#include "clock.h"
+
+/*
+	Monotonic milliseconds, used for every expiry in isr.
+	Wall clock jumps (NTP, suspend) must not resurrect or kill cached entries.
+*/
+uint64_t isr_clock_ms() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
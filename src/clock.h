@@ -0,0 +1,16 @@
+/*
+		Copyright (C) 2023
+			Pribess (Heewon Cho)
+			Jhyub	(Janghyub Seo)
+		src/clock.h
+*/
+
+#ifndef ISR_CLOCK
+#define ISR_CLOCK
+
+#include <stdint.h>
+#include <time.h>
+
+uint64_t isr_clock_ms();
+
+#endif
@@ -14,5 +14,14 @@ void isr_load_config() {
 	char dir[] = "/home/jhyub/isrtest/isr.d";
 	isr_config.getter_script_dir = malloc(sizeof(dir));
 	strcpy(isr_config.getter_script_dir, dir);
+
+	isr_config.control_socket = strdup("/run/isr.sock");
+
+	isr_config.state_refresh_interval = 0;
+	isr_config.decision_cache_size = 4096;
+	isr_config.response_cache_bytes = 4 * 1024 * 1024;
+	isr_config.scoped_cache = true;
+	isr_config.script_reload = true;
+	isr_config.script_budget = 50;
 }
 
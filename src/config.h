@@ -8,11 +8,19 @@
 #ifndef ISR_CONFIG
 #define ISR_CONFIG
 
+#include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
 
 struct config {
 	char *getter_script_dir;
+	char *control_socket; /* NULL disables the admin control socket */
+	unsigned int state_refresh_interval; /* ms, 0 polls state providers on every query */
+	size_t decision_cache_size;
+	size_t response_cache_bytes;
+	bool scoped_cache; /* cache answers given for a client subnet per subnet, instead of not at all */
+	bool script_reload; /* reload isr.js whenever anything in getter_script_dir changes */
+	unsigned int script_budget; /* ms a single resolve() may run before its query fails, 0 for no limit */
 };
 
 void isr_load_config();
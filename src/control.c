@@ -0,0 +1,167 @@
+/*
+		Copyright (C) 2023
+			Pribess (Heewon Cho)
+			Jhyub	(Janghyub Seo)
+		src/control.c
+*/
+
+#include "control.h"
+
+extern struct config isr_config;
+
+/*
+	Admin control socket, a unix stream socket taking one command per connection:
+
+	has <name> <type>
+	get <name> <type>                 -> <ttl> <response in hex>
+	put <name> <type> <ttl> <rdata in hex>
+	invalidate <name>                 -> number of dropped entries
+	invalidate-suffix <zone>          -> number of dropped entries
+	stats
+*/
+
+int isr_control_open() {
+	if (isr_config.control_socket == NULL) return -1;
+
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof(struct sockaddr_un));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, isr_config.control_socket, sizeof(addr.sun_path) - 1);
+
+	int controlfd;
+	if ((controlfd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+		perror("isr: control");
+		return -1;
+	}
+
+	unlink(isr_config.control_socket);
+	if (bind(controlfd, (struct sockaddr *)&addr, sizeof(struct sockaddr_un)) < 0 || listen(controlfd, 4) < 0) {
+		perror("isr: control");
+		close(controlfd);
+		return -1;
+	}
+
+	return controlfd;
+}
+
+size_t isr_control_unhex(const char *hex, unsigned char *buff, size_t size) {
+	size_t ret = 0;
+
+	for (; hex[0] != '\0' && hex[1] != '\0' && ret < size; hex += 2) {
+		unsigned int octet;
+		if (sscanf(hex, "%2x", &octet) != 1) break;
+		buff[ret++] = octet;
+	}
+
+	return ret;
+}
+
+void isr_control_command(char *line, FILE *out) {
+	char *command = strtok(line, " \t\r\n");
+	char *name = strtok(NULL, " \t\r\n");
+
+	if (command == NULL) return;
+
+	if (strcmp(command, "stats") == 0) {
+		struct response_cache_stats responses;
+		isr_response_cache_stats(&responses);
+
+		struct name_stats names;
+		isr_name_stats(&names);
+
+		struct script_stats script;
+		isr_script_stats(&script);
+
+		struct lookup_stats lookups;
+		isr_native_lookup_stats(&lookups);
+
+		fprintf(out, "entries %zu\nbytes %zu\nhits %lu\nmisses %lu\nevictions %lu\ndecisions %zu\ntemplates %zu\nnames %zu\nname_bytes %zu\n",
+			responses.entries, responses.bytes, responses.hits, responses.misses, responses.evictions,
+			isr_decision_count(), isr_template_count(), names.nodes, names.bytes);
+		fprintf(out, "script_calls %lu\nscript_budget_exceeded %lu\nscript_slowest_ms %lu\n",
+			script.calls, script.budget_exceeded, (unsigned long) script.slowest);
+		for (struct script_overrun *overrun = script.overruns; overrun != NULL; overrun = overrun->next) {
+			fprintf(out, "script_budget_exceeded %s %lu\n", overrun->script, overrun->count);
+		}
+		fprintf(out, "lookups %lu\nlookup_hits %lu\nlookup_coalesced %lu\nlookup_answered %lu\nlookup_timeouts %lu\nlookup_ms_total %lu\nlookup_slowest_ms %lu\nlookup_cached %zu\n",
+			lookups.lookups, lookups.hits, lookups.coalesced, lookups.answered, lookups.timeouts,
+			(unsigned long) lookups.total_ms, (unsigned long) lookups.slowest_ms, lookups.cached);
+		return;
+	}
+
+	if (name == NULL) {
+		fprintf(out, "error: missing name\n");
+		return;
+	}
+
+	if (strcmp(command, "invalidate") == 0 || strcmp(command, "invalidate-suffix") == 0) {
+		bool subtree = strcmp(command, "invalidate-suffix") == 0;
+		fprintf(out, "%zu\n", isr_response_cache_invalidate(name, subtree) + isr_decision_invalidate(name, subtree));
+		return;
+	}
+
+	char *type = strtok(NULL, " \t\r\n");
+	if (type == NULL) {
+		fprintf(out, "error: missing type\n");
+		return;
+	}
+
+	struct question question = { .qname = name, .qtype = atoi(type), .qclass = 1 };
+
+	if (strcmp(command, "has") == 0) {
+		fprintf(out, "%s\n", isr_response_cache_peek(&question) != NULL ? "yes" : "no");
+	} else if (strcmp(command, "get") == 0) {
+		struct cached_response *cached = isr_response_cache_peek(&question);
+		if (cached == NULL) {
+			fprintf(out, "miss\n");
+			return;
+		}
+
+		unsigned char *buff = malloc(cached->length * sizeof(unsigned char));
+		size_t length = isr_response_cache_copy(cached, buff, cached->length);
+
+		fprintf(out, "%u ", isr_response_cache_ttl(cached));
+		for (size_t i = 0; i < length; i++) {
+			fprintf(out, "%02x", buff[i]);
+		}
+		fprintf(out, "\n");
+
+		free(buff);
+	} else if (strcmp(command, "put") == 0) {
+		char *ttl = strtok(NULL, " \t\r\n");
+		char *rdata = strtok(NULL, " \t\r\n");
+		if (ttl == NULL || rdata == NULL) {
+			fprintf(out, "error: missing ttl or rdata\n");
+			return;
+		}
+
+		unsigned char buff[UINT16_MAX];
+		size_t length = isr_control_unhex(rdata, buff, sizeof(buff));
+
+		fprintf(out, "%s\n", isr_response_cache_put(name, question.qtype, strtoul(ttl, NULL, 10), buff, length) ? "ok" : "error");
+	} else {
+		fprintf(out, "error: unknown command %s\n", command);
+	}
+}
+
+void isr_control_accept(int controlfd) {
+	int connfd = accept(controlfd, NULL, NULL);
+	if (connfd < 0) return;
+
+	/* The whole server waits on this, so a client that never finishes its line is cut off */
+	struct timeval timeout = { .tv_sec = 1, .tv_usec = 0 };
+	setsockopt(connfd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(struct timeval));
+
+	FILE *conn = fdopen(connfd, "r+");
+	if (conn == NULL) {
+		close(connfd);
+		return;
+	}
+
+	char line[1024 + 2 * UINT16_MAX];
+	if (fgets(line, sizeof(line), conn) != NULL) {
+		isr_control_command(line, conn);
+	}
+
+	fclose(conn);
+}
@@ -0,0 +1,33 @@
+/*
+		Copyright (C) 2023
+			Pribess (Heewon Cho)
+			Jhyub	(Janghyub Seo)
+		src/control.h
+*/
+
+#ifndef ISR_CONTROL
+#define ISR_CONTROL
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#include "config.h"
+#include "cache/decision.h"
+#include "cache/name.h"
+#include "cache/response.h"
+#include "cache/template.h"
+#include "script/engine.h"
+#include "script/native/lookup.h"
+
+int isr_control_open();
+
+void isr_control_accept(int controlfd);
+
+#endif
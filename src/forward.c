@@ -0,0 +1,204 @@
+/*
+		Copyright (C) 2023
+			Pribess (Heewon Cho)
+			Jhyub	(Janghyub Seo)
+		src/forward.c
+*/
+
+#include "forward.h"
+
+int forward_listenfd = -1;
+int forward_fd = -1;
+void (*forward_reply)(int sockfd, unsigned char *resp, size_t len, struct query_source *source) = NULL;
+
+struct forward *forwards[65536];
+size_t forwards_size = 0;
+
+/*
+	Opens the socket queries are forwarded from, replies going back to clients through listenfd
+	by reply, the same way direct answers do.
+	Returns the upstream socket so the caller can wait on it.
+*/
+int isr_forward_init(int listenfd, void (*reply)(int sockfd, unsigned char *resp, size_t len, struct query_source *source)) {
+	forward_listenfd = listenfd;
+	forward_reply = reply;
+
+	if ((forward_fd = socket(AF_INET, SOCK_DGRAM, 0)) < 0) {
+		perror("isr: forward");
+		return -1;
+	}
+
+	return forward_fd;
+}
+
+/*
+	Upstream IDs are random so that replies can't be spoofed by guessing the client's.
+*/
+bool isr_forward_id(uint16_t *id) {
+	for (int tries = 0; tries < 16; tries++) {
+		if (getrandom(id, sizeof(uint16_t), 0) != sizeof(uint16_t)) return false;
+		if (forwards[*id] == NULL) return true;
+	}
+
+	return false;
+}
+
+struct forward *isr_forward_send(struct packet_view *view, const char *ip, bool cacheable) {
+	if (forward_fd < 0 || view->size > 512) return NULL;
+
+	struct sockaddr_in upstream;
+	memset(&upstream, 0, sizeof(struct sockaddr_in));
+	upstream.sin_family = AF_INET;
+	upstream.sin_port = htons(53);
+	if (inet_pton(AF_INET, ip, &upstream.sin_addr) != 1) {
+		printf("isr: can't forward to %s\n", ip);
+		return NULL;
+	}
+
+	uint16_t id;
+	if (!isr_forward_id(&id)) return NULL;
+
+	unsigned char query[512];
+	memcpy(query, view->packet, view->size);
+	*(uint16_t *)(query + 0) = htons(id);
+
+	if (sendto(forward_fd, query, view->size, 0, (struct sockaddr *)&upstream, sizeof(struct sockaddr_in)) < 0) return NULL;
+
+	struct forward *forward = malloc(sizeof(struct forward));
+	forward->id = view->header.id;
+	forward->upstream = upstream;
+	strcpy(forward->qname, isr_view_qname(view));
+	forward->qtype = view->qtype;
+	forward->qclass = view->qclass;
+	forward->subnet = view->subnet;
+	forward->cacheable = cacheable;
+	forward->expire = isr_clock_ms() + ISR_FORWARD_TIMEOUT;
+	forward->done = NULL;
+	forward->user = NULL;
+
+	forwards[id] = forward;
+	forwards_size++;
+
+	return forward;
+}
+
+bool isr_forward_query(struct packet_view *view, const char *ip, struct query_source *source, bool cacheable) {
+	struct forward *forward = isr_forward_send(view, ip, cacheable);
+	if (forward == NULL) return false;
+
+	forward->source = *source;
+
+	return true;
+}
+
+/*
+	Asks upstream on isr's own behalf, done getting the reply (or NULL on timeout) instead of a client.
+	The reply is only what that upstream said, so it isn't cached for answering clients.
+*/
+bool isr_forward_lookup(struct packet_view *view, const char *ip, void (*done)(struct forward *forward, struct packet_view *view), void *user) {
+	struct forward *forward = isr_forward_send(view, ip, false);
+	if (forward == NULL) return false;
+
+	memset(&forward->source, 0, sizeof(struct query_source));
+	forward->done = done;
+	forward->user = user;
+
+	return true;
+}
+
+void isr_forward_cache(struct forward *forward, struct packet_view *view) {
+	/* Negative answers are cached too, as long as they carry the SOA their TTL comes from */
+	if (view->header.tc) return;
+	if (view->header.rcode == 0 && view->header.ancount == 0 && view->header.nscount == 0) return;
+	if (view->header.rcode != 0 && (view->header.rcode != 3 || view->header.nscount == 0)) return;
+
+	uint16_t ttl_offsets[ISR_WRITER_TTLS];
+	size_t ttl_offsets_length;
+	if (!isr_view_ttls(view, ttl_offsets, &ttl_offsets_length, ISR_WRITER_TTLS)) return;
+
+	/* Our own OPT goes on when serving, so upstream's is cut off, which only works if it is last */
+	size_t length = view->size;
+	if (view->edns) {
+		if (view->opt_rdata + view->opt_rdlength != view->size) return;
+		length = view->opt_offset;
+	}
+
+	/* An answer upstream tailored to the client's subnet is only for clients in its scope */
+	uint8_t scope = forward->subnet.ecs && view->subnet.ecs ? view->subnet.scope : 0;
+
+	struct question question = {
+		.qname = forward->qname,
+		.qtype = forward->qtype,
+		.qclass = forward->qclass,
+		.subnet = &forward->subnet,
+	};
+
+	unsigned char *wire = malloc(length * sizeof(unsigned char));
+	memcpy(wire, view->packet, length);
+	if (view->edns) *(uint16_t *)(wire + 10) = htons(view->header.arcount - 1);
+
+	if (isr_response_cache_store(&question, scope, wire, length, view->question_length, ttl_offsets, ttl_offsets_length) == NULL) free(wire);
+}
+
+void isr_forward_receive() {
+	unsigned char buf[4096];
+	struct sockaddr_in from;
+	socklen_t fromlen = sizeof(struct sockaddr_in);
+
+	int cnt = recvfrom(forward_fd, buf, sizeof(buf), 0, (struct sockaddr *)&from, &fromlen);
+	if (cnt < 12) return;
+
+	struct packet_view view;
+	if (!isr_view_parse(&view, buf, cnt) || view.header.qr != 1) return;
+
+	struct forward *forward = forwards[view.header.id];
+	if (forward == NULL) return;
+
+	/* Anything not coming from where we asked, or not answering what we asked, is dropped */
+	if (from.sin_addr.s_addr != forward->upstream.sin_addr.s_addr || from.sin_port != forward->upstream.sin_port) return;
+	if (view.qtype != forward->qtype || view.qclass != forward->qclass || strcasecmp(isr_view_qname(&view), forward->qname) != 0) return;
+
+	forwards[view.header.id] = NULL;
+	forwards_size--;
+
+	if (forward->cacheable) isr_forward_cache(forward, &view);
+
+	if (forward->done != NULL) {
+		forward->done(forward, &view);
+	} else {
+		*(uint16_t *)(buf + 0) = htons(forward->id);
+		forward_reply(forward_listenfd, buf, cnt, &forward->source);
+	}
+
+	free(forward);
+}
+
+/*
+	Keeps the replies to every query in flight out of the response cache,
+	as the scripts that decided to forward them have just been replaced.
+*/
+void isr_forward_uncache() {
+	for (size_t i = 0; i < 65536 && forwards_size > 0; i++) {
+		if (forwards[i] != NULL) forwards[i]->cacheable = false;
+	}
+}
+
+/*
+	Gives up on queries whose upstream never replied; their clients will retry.
+*/
+void isr_forward_sweep() {
+	static uint64_t last_sweep = 0;
+
+	uint64_t now = isr_clock_ms();
+	if (forwards_size == 0 || now - last_sweep < 1000) return;
+	last_sweep = now;
+
+	for (size_t i = 0; i < 65536; i++) {
+		if (forwards[i] == NULL || now < forwards[i]->expire) continue;
+
+		if (forwards[i]->done != NULL) forwards[i]->done(forwards[i], NULL);
+		free(forwards[i]);
+		forwards[i] = NULL;
+		forwards_size--;
+	}
+}
@@ -0,0 +1,57 @@
+/*
+		Copyright (C) 2023
+			Pribess (Heewon Cho)
+			Jhyub	(Janghyub Seo)
+		src/forward.h
+*/
+
+#ifndef ISR_FORWARD
+#define ISR_FORWARD
+
+#include <arpa/inet.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <sys/random.h>
+#include <sys/socket.h>
+
+#include "clock.h"
+#include "cache/response.h"
+#include "packet/view.h"
+#include "packet/writer.h"
+
+#define ISR_FORWARD_TIMEOUT 5000
+
+/*
+	A query waiting for its upstream, found again by the ID we sent it with.
+*/
+struct forward {
+	uint16_t id; /* the client's */
+	struct query_source source; /* where the client's query came in, which the reply goes back out of */
+	struct sockaddr_in upstream;
+	char qname[256];
+	uint16_t qtype;
+	uint16_t qclass;
+	struct client_subnet subnet; /* the ECS option passed on upstream, if subnet.ecs */
+	bool cacheable;
+	uint64_t expire;
+	void (*done)(struct forward *forward, struct packet_view *view); /* called instead of replying to client, view being NULL if upstream never replied */
+	void *user;
+};
+
+int isr_forward_init(int listenfd, void (*reply)(int sockfd, unsigned char *resp, size_t len, struct query_source *source));
+
+bool isr_forward_query(struct packet_view *view, const char *ip, struct query_source *source, bool cacheable);
+
+bool isr_forward_lookup(struct packet_view *view, const char *ip, void (*done)(struct forward *forward, struct packet_view *view), void *user);
+
+void isr_forward_receive();
+
+void isr_forward_sweep();
+
+void isr_forward_uncache();
+
+#endif
@@ -5,6 +5,7 @@
 		src/isr.c
 */
 
+#define _GNU_SOURCE /* recvmmsg */
 #define ISR_VERSION "0.01"
 
 #include <stdio.h>
@@ -14,15 +15,23 @@
 #include <errno.h>
 #include <locale.h>
 #include <arpa/inet.h>
+#include <netinet/in.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/time.h>
 #include <sys/select.h>
 
-#include "packet/header.h"
-#include "packet/question.h"
+#include "config.h"
+#include "control.h"
+#include "query.h"
+#include "reload.h"
 
 void udp_loop();
 
+int isr_receive_batch(int sockfd, struct query_packet *packets, size_t count);
+
+void isr_reply(int sockfd, unsigned char *resp, size_t len, struct query_source *source);
+
 int main(int argc, char *argv[]) {
 	setlocale(LC_ALL, "");
 
@@ -39,18 +48,35 @@ int main(int argc, char *argv[]) {
 		return 0;
 	}
 
+	isr_load_config();
+
+	jerry_init(JERRY_INIT_EMPTY);
+
+	if (!isr_query_init()) {
+		isr_module_registry_clear();
+		jerry_cleanup();
+		return 1;
+	}
+
 	udp_loop();
 
+	isr_module_registry_clear();
+	jerry_cleanup();
+
 	return 0;
 }
 
+/*
+	Datagrams received in one go, which are too large for the stack together.
+*/
+struct query_packet isr_packets[ISR_QUERY_BATCH];
+
 void udp_loop() {
 	printf("UDP server initializing...\n");
 
 	int sockfd;
 
 	struct sockaddr_in addr;
-	struct sockaddr_in clientaddr;
 	socklen_t addrlen = sizeof(struct sockaddr_in);
 
 	addr.sin_family = AF_INET;
@@ -67,13 +93,135 @@ void udp_loop() {
 		exit(-1);
 	}
 
+	int on = 1;
+	if (setsockopt(sockfd, IPPROTO_IP, IP_PKTINFO, &on, sizeof(on)) < 0) perror("isr: IP_PKTINFO");
+
 	printf("UDP server successfully initialized!\n");
 
-	unsigned char *buf[512];
+	int controlfd = isr_control_open();
+	int forwardfd = isr_forward_init(sockfd, &isr_reply);
+	int reloadfd = isr_reload_open();
+
+	unsigned char resp[ISR_QUERY_UDP_SIZE];
+
+	fd_set fds;
+	int maxfd = sockfd;
+	if (controlfd > maxfd) maxfd = controlfd;
+	if (forwardfd > maxfd) maxfd = forwardfd;
+	if (reloadfd > maxfd) maxfd = reloadfd;
 
 	while (true) {
-		int cnt = recvfrom(sockfd, buf, sizeof(buf), 0, (struct sockaddr *)&clientaddr, &addrlen);
-		
-		// handling request with packet in buf and packet length in cnt
+		/* Async resolve() calls move on here, and the queries of those that settled are answered */
+		isr_script_jobs(isr_query_parked_count());
+
+		struct query_source parked;
+		size_t parked_len;
+		while (isr_query_resume(resp, sizeof(resp), &parked_len, &parked)) {
+			if (parked_len > 0) isr_reply(sockfd, resp, parked_len, &parked);
+		}
+
+		FD_ZERO(&fds);
+		FD_SET(sockfd, &fds);
+		if (controlfd >= 0) FD_SET(controlfd, &fds);
+		if (forwardfd >= 0) FD_SET(forwardfd, &fds);
+		if (reloadfd >= 0) FD_SET(reloadfd, &fds);
+
+		struct timeval timeout = { .tv_sec = 1, .tv_usec = 0 };
+		if (select(maxfd + 1, &fds, NULL, NULL, &timeout) < 0) continue;
+
+		isr_forward_sweep();
+
+		if (controlfd >= 0 && FD_ISSET(controlfd, &fds)) isr_control_accept(controlfd);
+		if (forwardfd >= 0 && FD_ISSET(forwardfd, &fds)) isr_forward_receive();
+		if (reloadfd >= 0 && FD_ISSET(reloadfd, &fds)) isr_reload_handle(reloadfd);
+		if (!FD_ISSET(sockfd, &fds)) continue;
+
+		for (size_t i = 0; i < ISR_QUERY_BATCH; i++) {
+			isr_packets[i].source = (struct query_source) { .listener = addr, .interface = 0, .transport = "udp" };
+		}
+
+		int cnt = isr_receive_batch(sockfd, isr_packets, ISR_QUERY_BATCH);
+		if (cnt <= 0) continue;
+
+		isr_query_handle_batch(isr_packets, cnt);
+
+		for (int i = 0; i < cnt; i++) {
+			if (isr_packets[i].resp_length > 0) isr_reply(sockfd, isr_packets[i].resp, isr_packets[i].resp_length, &isr_packets[i].source);
+		}
+	}
+}
+
+/*
+	Receives the datagrams waiting, count at most, along with the address each was sent to and
+	the interface it came in on, which the socket being bound to INADDR_ANY doesn't tell otherwise.
+	Returns how many were received.
+*/
+int isr_receive_batch(int sockfd, struct query_packet *packets, size_t count) {
+	struct mmsghdr msgs[ISR_QUERY_BATCH];
+	struct iovec iovs[ISR_QUERY_BATCH];
+	unsigned char controls[ISR_QUERY_BATCH][CMSG_SPACE(sizeof(struct in_pktinfo))];
+
+	if (count > ISR_QUERY_BATCH) count = ISR_QUERY_BATCH;
+
+	for (size_t i = 0; i < count; i++) {
+		iovs[i] = (struct iovec) { .iov_base = packets[i].req, .iov_len = sizeof(packets[i].req) };
+
+		msgs[i].msg_hdr = (struct msghdr) {
+			.msg_name = &packets[i].source.peer,
+			.msg_namelen = sizeof(struct sockaddr_in),
+			.msg_iov = &iovs[i],
+			.msg_iovlen = 1,
+			.msg_control = controls[i],
+			.msg_controllen = sizeof(controls[i]),
+		};
 	}
+
+	/* select() said there is one at least, so only those already there are waited for */
+	int ret = recvmmsg(sockfd, msgs, count, MSG_DONTWAIT, NULL);
+	if (ret < 0) return ret;
+
+	for (int i = 0; i < ret; i++) {
+		packets[i].req_size = msgs[i].msg_len;
+
+		struct msghdr *msg = &msgs[i].msg_hdr;
+		for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg); cmsg != NULL; cmsg = CMSG_NXTHDR(msg, cmsg)) {
+			if (cmsg->cmsg_level != IPPROTO_IP || cmsg->cmsg_type != IP_PKTINFO) continue;
+
+			struct in_pktinfo pktinfo;
+			memcpy(&pktinfo, CMSG_DATA(cmsg), sizeof(struct in_pktinfo));
+			packets[i].source.listener.sin_addr = pktinfo.ipi_addr;
+			packets[i].source.interface = pktinfo.ipi_ifindex;
+		}
+	}
+
+	return ret;
+}
+
+/*
+	Replies from the address the query was sent to, so clients of a multihomed host
+	don't get an answer from an address they never asked.
+*/
+void isr_reply(int sockfd, unsigned char *resp, size_t len, struct query_source *source) {
+	struct iovec iov = { .iov_base = resp, .iov_len = len };
+	unsigned char control[CMSG_SPACE(sizeof(struct in_pktinfo))];
+	memset(control, 0, sizeof(control));
+
+	struct msghdr msg = {
+		.msg_name = &source->peer,
+		.msg_namelen = sizeof(struct sockaddr_in),
+		.msg_iov = &iov,
+		.msg_iovlen = 1,
+		.msg_control = control,
+		.msg_controllen = sizeof(control),
+	};
+
+	struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = IPPROTO_IP;
+	cmsg->cmsg_type = IP_PKTINFO;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(struct in_pktinfo));
+
+	struct in_pktinfo pktinfo = { .ipi_ifindex = 0, .ipi_spec_dst = source->listener.sin_addr };
+	memcpy(CMSG_DATA(cmsg), &pktinfo, sizeof(struct in_pktinfo));
+
+	sendmsg(sockfd, &msg, 0);
 }
@@ -14,6 +14,7 @@
 #include <string.h>
 
 struct record {
+    char *name; /* dotted owner name, NULL meaning the question name */
     uint16_t type;
     uint16_t class;
     uint32_t ttl;
@@ -21,6 +22,4 @@ struct record {
     unsigned char *rdata;
 };
 
-unsigned char *isr_serialize_record(size_t *len, struct record *record);
-
 #endif
@@ -11,7 +11,15 @@ struct header *isr_deserialize_header(unsigned char *req) {
 	struct header *rst;
 
 	rst = malloc(sizeof(struct header));
+	isr_read_header(rst, req);
 
+	return rst;
+}
+
+/*
+	Decodes the 12 byte header at req into rst, for callers keeping it on the stack.
+*/
+void isr_read_header(struct header *rst, unsigned char *req) {
 	rst->id = ntohs(*(uint16_t *)(req + 0));
 
 	rst->qr = (req[2] & 0x80) >> 7;
@@ -28,31 +36,4 @@ struct header *isr_deserialize_header(unsigned char *req) {
 	rst->ancount = ntohs(*(uint16_t *)(req + 6));
 	rst->nscount = ntohs(*(uint16_t *)(req + 8));
 	rst->arcount = ntohs(*(uint16_t *)(req + 10));
-
-	return rst;
-}
-
-unsigned char *isr_serialize_header(size_t *len, struct header *header) {
-	unsigned char *rst;
-	rst = malloc(12 * sizeof(char));
-	*len = 12;
-
-	*(uint16_t *)(rst + 0) = htons(header->id);
-
-	rst[2] = (header->qr << 7) 
-		+ (header->opcode << 3)
-		+ (header->aa << 2)
-		+ (header->tc << 1)
-		+ (header->rd << 0);
-
-	rst[3] = (header->ra << 7)
-	+ (header->z << 4)
-	+ (header->rcode << 0);
-
-	*(uint16_t *)(rst + 4) = htons(header->qdcount);
-	*(uint16_t *)(rst + 6) = htons(header->ancount);
-	*(uint16_t *)(rst + 8) = htons(header->nscount);
-	*(uint16_t *)(rst + 10) = htons(header->arcount);
-
-	return rst;
 }
@@ -0,0 +1,90 @@
+/*
+		Copyright (C) 2023
+			Pribess (Heewon Cho)
+			Jhyub	(Janghyub Seo)
+		src/packet/label.c
+*/
+
+#include "label.h"
+
+/* Loaded at 16 - n, gives n bytes of 0xFF followed by zeroes */
+const unsigned char isr_label_mask[32] = {
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+
+/*
+	Lowercases the ASCII letters of eight bytes at once, leaving every other byte alone.
+*/
+uint64_t isr_label_lower_word(uint64_t word) {
+	uint64_t heptets = word & 0x7F7F7F7F7F7F7F7Full;
+	uint64_t ge_a = heptets + 0x3F3F3F3F3F3F3F3Full; /* high bit set from 'A' up */
+	uint64_t gt_z = heptets + 0x2525252525252525ull; /* high bit set past 'Z' */
+	uint64_t upper = ~word & (ge_a ^ gt_z) & 0x8080808080808080ull;
+
+	return word | (upper >> 2);
+}
+
+/*
+	Lowercases label into lower and hashes it in the same pass, 16 bytes at a time.
+	Bytes past the label are read only while they are within readable,
+	but up to ISR_LABEL_SLACK bytes past the label in lower may be overwritten.
+	Both paths zero the bytes past the label before hashing, so they agree on the hash.
+	There is no AVX2 path: a label is at most 63 octets and the hash is chained per
+	16 bytes anyway, and folding 32 bytes at a time measured slower at every length.
+*/
+uint32_t isr_label_fold(const unsigned char *label, size_t length, size_t readable, unsigned char *lower) {
+	uint64_t hash = 0x9E3779B97F4A7C15ull ^ length;
+
+	for (size_t i = 0; i < length; i += 16) {
+		size_t n = length - i < 16 ? length - i : 16;
+		uint64_t words[2];
+
+#ifdef __SSE2__
+		__m128i chunk;
+		if (i + 16 <= readable) {
+			chunk = _mm_loadu_si128((const __m128i *) (label + i));
+		} else {
+			unsigned char tail[16] = { 0 };
+			memcpy(tail, label + i, n);
+			chunk = _mm_loadu_si128((const __m128i *) tail);
+		}
+		chunk = _mm_and_si128(chunk, _mm_loadu_si128((const __m128i *) (isr_label_mask + 16 - n)));
+
+		/* Signed compares, so bytes from 0x80 up are never taken for letters */
+		__m128i upper = _mm_and_si128(_mm_cmpgt_epi8(chunk, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(chunk, _mm_set1_epi8('Z' + 1)));
+		chunk = _mm_or_si128(chunk, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+
+		_mm_storeu_si128((__m128i *) (lower + i), chunk);
+		memcpy(words, lower + i, 16);
+#else
+		words[0] = 0;
+		words[1] = 0;
+		memcpy(words, label + i, n);
+
+		words[0] = isr_label_lower_word(words[0]);
+		words[1] = isr_label_lower_word(words[1]);
+
+		memcpy(lower + i, words, 16);
+#endif
+
+		hash ^= words[0];
+		hash *= 0xFF51AFD7ED558CCDull;
+		hash ^= hash >> 32;
+		hash ^= words[1];
+		hash *= 0xC4CEB9FE1A85EC53ull;
+		hash ^= hash >> 29;
+	}
+
+	return (uint32_t) (hash ^ (hash >> 32));
+}
+
+/*
+	Hash of a name from the hash of its parent and of its leftmost label,
+	so a name's hash only depends on its suffix, like the name arena wants.
+*/
+uint32_t isr_label_chain(uint32_t parent, uint32_t label) {
+	uint32_t ret = (parent ^ label) * 16777619u;
+	ret ^= ret >> 15;
+
+	return ret;
+}
@@ -0,0 +1,26 @@
+/*
+		Copyright (C) 2023
+			Pribess (Heewon Cho)
+			Jhyub	(Janghyub Seo)
+		src/packet/label.h
+*/
+
+#ifndef ISR_PACKET_LABEL
+#define ISR_PACKET_LABEL
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define ISR_LABEL_ROOT 2166136261u
+#define ISR_LABEL_SLACK 16 /* lower may be written this far past the label */
+
+uint32_t isr_label_fold(const unsigned char *label, size_t length, size_t readable, unsigned char *lower);
+
+uint32_t isr_label_chain(uint32_t parent, uint32_t label);
+
+#endif
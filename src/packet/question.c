@@ -6,6 +6,7 @@
 */
 
 #include "question.h"
+#include "view.h"
 
 /*
 	DNS specification seems to be originally intended to support multiple questions,
@@ -13,73 +14,65 @@
 	respond multiple answers to multiple questions.
 	Hence, we will only deserialize the first question and use it exclusively,
 	and return an reply with qdcount=1.
-	This results in that we won't need to understand compressed messages,
-	since it won't be possible to compress anything while writing the first question.
+	Nothing before the first question could be pointed to, but its name is still read
+	through isr_view_name, which follows compression pointers and rejects ones that
+	don't point backwards, so a crafted question can't make us read out of bounds.
 */
-struct question *isr_deserialize_question(unsigned char *body, uint16_t qdcount) {
+struct question *isr_deserialize_question(unsigned char *body, size_t size, uint16_t qdcount) {
 	if (qdcount != 1) {
 		return NULL;
 	}
 
+	/* Every length is checked against size, a malformed question is simply not one */
+	char name[256];
+	size_t cursor = 0;
+	if (!isr_view_name(body, size, &cursor, name)) return NULL;
+	if (cursor + 4 > size) return NULL;
+
 	struct question *rst;
 	rst = malloc(sizeof(struct question));
 
-	uint16_t cursor = 0;
-        
-	char name[255];
-	int namelen = 0;
-
-	while (true) {
-		int labellen = body[cursor++];
-		if (labellen == 0) break;
-
-		memcpy(name + namelen, body + cursor, labellen);
-		namelen += labellen;
-		cursor += labellen;
-			
-		name[namelen++] = '.';
-	}
-	name[namelen-1] = '\0';
-		
-	rst->qname = malloc(namelen * sizeof(char));
-	strcpy(rst->qname, name);
+	rst->qname = strdup(name);
 	rst->qtype = ntohs(*(uint16_t *)(body + cursor));
 	cursor += 2;
 	rst->qclass = ntohs(*(uint16_t *)(body + cursor));
 	cursor += 2;
+	rst->name = NULL;
+	rst->subnet = NULL;
+	rst->source = NULL;
+	rst->view = NULL;
 
 	return rst;
 }
 
-unsigned char *isr_serialize_question(size_t *len, struct question *question) {
-	/*
-		question->qname is a plain domain string such as "example.com",
-		while what we want is this: 7 e x a m p l e 3 c o m 0
+/*
+	The network of client an answer given for scope bits of it applies to.
+	Its prefix is the scope, so the answer can be looked up by isr_subnet_covers later.
+*/
+void isr_subnet_scope(struct client_subnet *ret, struct client_subnet *client, uint8_t scope) {
+	memset(ret, 0, sizeof(struct client_subnet));
+	if (client == NULL || scope == 0) return;
 
-		this results in: actual qname field length = qname string length + 2 (first length ocetet, last null octet)
-	*/
-	*len = strlen(question->qname) + 2 + 4;
+	ret->family = client->family;
+	ret->prefix = scope < client->prefix ? scope : client->prefix;
+	ret->scope = ret->prefix;
+	ret->ecs = client->ecs;
 
-	unsigned char *rst;
-	rst = malloc(*len * sizeof(char));
+	memcpy(ret->address, client->address, (ret->prefix + 7) / 8);
+	if (ret->prefix % 8 != 0) ret->address[ret->prefix / 8] &= 0xFF << (8 - ret->prefix % 8);
+}
 
-	int cursor = 0;
-	int labelstart = 0;
-	for (int i = 0; true; i++) {
-		if (question->qname[i] == '.' || question->qname[i] == '\0') {
-			rst[cursor++] = i - labelstart;
-			memcpy(rst + cursor, question->qname + labelstart, i - labelstart);		
-			cursor += (i - labelstart);
-			labelstart = i + 1;
-			if (question->qname[i] == '\0') {
-				rst[cursor++] = 0;
-				break;
-			}
-		}
-	}
+/*
+	Whether client lies within scope, a scope of no bits covering everyone.
+*/
+bool isr_subnet_covers(struct client_subnet *scope, struct client_subnet *client) {
+	if (scope->prefix == 0) return true;
+	if (client == NULL || client->family != scope->family || client->prefix < scope->prefix) return false;
 
-	*(uint16_t *)(rst + cursor) = htons(question->qtype);
-	*(uint16_t *)(rst + cursor + 2) = htons(question->qclass);
+	size_t bytes = scope->prefix / 8;
+	if (memcmp(scope->address, client->address, bytes) != 0) return false;
+	if (scope->prefix % 8 == 0) return true;
 
-	return rst;
+	unsigned char mask = 0xFF << (8 - scope->prefix % 8);
+	return (scope->address[bytes] & mask) == (client->address[bytes] & mask);
 }
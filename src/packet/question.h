@@ -9,19 +9,54 @@
 #define ISR_PACKET_QUESTION
 
 #include <arpa/inet.h>
+#include <netinet/in.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
+struct name;
+struct packet_view;
+
+#define ISR_SUBNET_IPV4 1
+#define ISR_SUBNET_IPV6 2
+
+/*
+	A client network as EDNS Client Subnet (RFC 7871) carries it: the address family,
+	the first prefix bits of the address (the rest zeroed) and the scope an answer was given for.
+*/
+struct client_subnet {
+	uint16_t family;
+	uint8_t prefix;
+	uint8_t scope;
+	unsigned char address[16];
+	bool ecs; /* from an ECS option, rather than the address the query came from */
+};
+
+/*
+	Where a query came in: who sent it, to which of our addresses, and how.
+*/
+struct query_source {
+	struct sockaddr_in peer;
+	struct sockaddr_in listener;
+	unsigned int interface; /* index of the interface it arrived on, 0 if unknown */
+	const char *transport;
+};
+
 struct question {
 	char *qname;
 	uint16_t qtype;
 	uint16_t qclass;
+	struct name *name; /* qname already found in the name arena, NULL meaning look it up */
+	struct client_subnet *subnet; /* who is asking, NULL if unknown */
+	struct query_source *source; /* NULL, like view, if the question didn't come off the network */
+	struct packet_view *view;
 };
 
-struct question *isr_deserialize_question(unsigned char *body, uint16_t qdcount);
+struct question *isr_deserialize_question(unsigned char *body, size_t size, uint16_t qdcount);
+
+void isr_subnet_scope(struct client_subnet *ret, struct client_subnet *client, uint8_t scope);
 
-unsigned char *isr_serialize_question(size_t *len, struct question *question);
+bool isr_subnet_covers(struct client_subnet *scope, struct client_subnet *client);
 
 #endif
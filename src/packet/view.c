@@ -0,0 +1,251 @@
+/*
+		Copyright (C) 2023
+			Pribess (Heewon Cho)
+			Jhyub	(Janghyub Seo)
+		src/packet/view.c
+*/
+
+#include "view.h"
+
+/*
+	Like isr_deserialize_question, only the first and only question is looked at.
+	Returns false if packet isn't a query we can read.
+*/
+bool isr_view_parse(struct packet_view *view, unsigned char *packet, size_t size) {
+	if (size < 12) return false;
+
+	view->packet = packet;
+	view->size = size;
+	view->qname_ready = false;
+
+	isr_read_header(&view->header, packet);
+	if (view->header.qdcount != 1) return false;
+
+	/* Validates, lowercases and hashes the qname in one pass */
+	size_t cursor = 12;
+	view->labels_length = 0;
+	while (true) {
+		if (cursor >= size) return false;
+
+		uint8_t labellen = packet[cursor];
+		view->lower[cursor - 12] = labellen;
+		if (labellen == 0) break;
+		if (labellen > 63) return false;
+		if (cursor + 1 + labellen >= size || cursor + 1 + labellen - 12 >= 255) return false;
+
+		view->labels[view->labels_length] = cursor - 12;
+		view->label_hashes[view->labels_length] = isr_label_fold(packet + cursor + 1, labellen, size - cursor - 1, view->lower + cursor - 12 + 1);
+		view->labels_length++;
+
+		cursor += labellen + 1;
+	}
+	cursor++;
+
+	view->qname_offset = 12;
+	view->qname_length = cursor - 12;
+
+	view->hash = ISR_LABEL_ROOT;
+	for (size_t i = view->labels_length; i > 0; i--) {
+		view->hash = isr_label_chain(view->hash, view->label_hashes[i - 1]);
+	}
+
+	if (cursor + 4 > size) return false;
+	view->qtype = ntohs(*(uint16_t *)(packet + cursor));
+	view->qclass = ntohs(*(uint16_t *)(packet + cursor + 2));
+	view->question_length = cursor + 4 - 12;
+
+	return isr_view_opt(view);
+}
+
+/*
+	Looks for the OPT record of EDNS (RFC 6891) in the additional section.
+	Returns false if the records after the question don't parse, there is more than one OPT
+	or its owner isn't the root name, all of which the query path answers with FORMERR.
+*/
+bool isr_view_opt(struct packet_view *view) {
+	view->edns = false;
+	view->udp_size = ISR_VIEW_UDP_SIZE;
+	view->edns_version = 0;
+	view->dnssec_ok = false;
+	memset(&view->subnet, 0, sizeof(struct client_subnet));
+
+	size_t cursor = 12 + view->question_length;
+	size_t additional = (size_t) view->header.ancount + view->header.nscount;
+	size_t count = additional + view->header.arcount;
+
+	for (size_t i = 0; i < count; i++) {
+		size_t start = cursor;
+
+		if (!isr_view_name(view->packet, view->size, &cursor, NULL)) return false;
+		if (cursor + 10 > view->size) return false;
+
+		uint16_t type = ntohs(*(uint16_t *)(view->packet + cursor));
+		uint16_t rdlength = ntohs(*(uint16_t *)(view->packet + cursor + 8));
+		if (cursor + 10 + rdlength > view->size) return false;
+
+		if (type == 41 && i >= additional) {
+			/* Its owner must be the root name (RFC 6891 6.1.2) */
+			if (view->edns || cursor != start + 1) return false;
+
+			uint16_t udp_size = ntohs(*(uint16_t *)(view->packet + cursor + 2));
+			view->edns = true;
+			view->udp_size = udp_size > ISR_VIEW_UDP_SIZE ? udp_size : ISR_VIEW_UDP_SIZE;
+			view->edns_version = view->packet[cursor + 5];
+			view->dnssec_ok = (view->packet[cursor + 6] & 0x80) != 0;
+			view->opt_offset = start;
+			view->opt_rdata = cursor + 10;
+			view->opt_rdlength = rdlength;
+
+			if (!isr_view_ecs(view)) return false;
+		}
+
+		cursor += 10 + rdlength;
+	}
+
+	return true;
+}
+
+/*
+	Looks for EDNS Client Subnet (RFC 7871) among the OPT options.
+	Returns false if it is malformed: an address longer than its prefix needs,
+	or with bits set past the prefix.
+*/
+bool isr_view_ecs(struct packet_view *view) {
+	const unsigned char *options = view->packet + view->opt_rdata;
+	size_t cursor = 0;
+
+	while (cursor + 4 <= view->opt_rdlength) {
+		uint16_t code = ntohs(*(uint16_t *)(options + cursor));
+		uint16_t length = ntohs(*(uint16_t *)(options + cursor + 2));
+		cursor += 4;
+		if (cursor + length > view->opt_rdlength) return false;
+
+		if (code == 8) {
+			if (view->subnet.ecs || length < 4) return false;
+
+			struct client_subnet *subnet = &view->subnet;
+			subnet->family = ntohs(*(uint16_t *)(options + cursor));
+			subnet->prefix = options[cursor + 2];
+			subnet->scope = options[cursor + 3];
+
+			size_t max = subnet->family == ISR_SUBNET_IPV4 ? 32 : subnet->family == ISR_SUBNET_IPV6 ? 128 : 0;
+			size_t bytes = (subnet->prefix + 7) / 8;
+			if (max == 0 || subnet->prefix > max || length - 4 != bytes) return false;
+
+			memset(subnet->address, 0, sizeof(subnet->address));
+			memcpy(subnet->address, options + cursor + 4, bytes);
+			if (subnet->prefix % 8 != 0 && (subnet->address[bytes - 1] & (0xFF >> (subnet->prefix % 8))) != 0) return false;
+
+			subnet->ecs = true;
+		}
+
+		cursor += length;
+	}
+
+	return true;
+}
+
+/*
+	Lowercased dotted form of the qname without the trailing dot, kept in the view itself.
+*/
+const char *isr_view_qname(struct packet_view *view) {
+	if (view->qname_ready) return view->qname;
+
+	unsigned char *wire = view->lower;
+	size_t cursor = 0;
+	size_t length = 0;
+
+	while (wire[cursor] != 0) {
+		uint8_t labellen = wire[cursor++];
+
+		if (length > 0) view->qname[length++] = '.';
+		memcpy(view->qname + length, wire + cursor, labellen);
+		length += labellen;
+		cursor += labellen;
+	}
+	view->qname[length] = '\0';
+
+	view->qname_ready = true;
+
+	return view->qname;
+}
+
+/*
+	Reads the name at *offset, following compression pointers, and moves *offset past it.
+	Pointers have to point backwards and at most ISR_VIEW_HOPS of them are followed,
+	so a crafted loop can't keep us here. name (256 bytes) may be NULL to only skip the name.
+*/
+bool isr_view_name(const unsigned char *packet, size_t size, size_t *offset, char *name) {
+	size_t cursor = *offset;
+	size_t next = 0; /* where the name ends in the message, known once the first pointer is seen */
+	size_t wire_length = 0;
+	size_t length = 0;
+	int hops = 0;
+
+	while (true) {
+		if (cursor >= size) return false;
+
+		uint8_t labellen = packet[cursor];
+
+		if ((labellen & 0xC0) == 0xC0) {
+			if (cursor + 1 >= size || ++hops > ISR_VIEW_HOPS) return false;
+
+			size_t target = ((labellen & 0x3F) << 8) | packet[cursor + 1];
+			if (target >= cursor) return false;
+
+			if (next == 0) next = cursor + 2;
+			cursor = target;
+			continue;
+		}
+
+		if (labellen > 63) return false;
+
+		wire_length += labellen + 1;
+		if (wire_length > 255) return false;
+
+		if (labellen == 0) break;
+		if (cursor + 1 + labellen > size) return false;
+
+		if (name != NULL) {
+			if (length > 0) name[length++] = '.';
+			memcpy(name + length, packet + cursor + 1, labellen);
+			length += labellen;
+		}
+
+		cursor += labellen + 1;
+	}
+
+	if (name != NULL) name[length] = '\0';
+	*offset = next != 0 ? next : cursor + 1;
+
+	return true;
+}
+
+/*
+	Walks every record after the question of a (usually upstream) message
+	and collects where their TTLs are. OPT borrows the TTL field for flags, so it is skipped.
+*/
+bool isr_view_ttls(struct packet_view *view, uint16_t *ttl_offsets, size_t *ttl_offsets_length, size_t capacity) {
+	size_t cursor = 12 + view->question_length;
+	size_t count = (size_t) view->header.ancount + view->header.nscount + view->header.arcount;
+
+	*ttl_offsets_length = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		if (!isr_view_name(view->packet, view->size, &cursor, NULL)) return false;
+		if (cursor + 10 > view->size) return false;
+
+		uint16_t type = ntohs(*(uint16_t *)(view->packet + cursor));
+		uint16_t rdlength = ntohs(*(uint16_t *)(view->packet + cursor + 8));
+
+		if (type != 41) {
+			if (*ttl_offsets_length >= capacity || cursor + 4 > UINT16_MAX) return false;
+			ttl_offsets[(*ttl_offsets_length)++] = cursor + 4;
+		}
+
+		cursor += 10 + rdlength;
+		if (cursor > view->size) return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,70 @@
+/*
+		Copyright (C) 2023
+			Pribess (Heewon Cho)
+			Jhyub	(Janghyub Seo)
+		src/packet/view.h
+*/
+
+#ifndef ISR_PACKET_VIEW
+#define ISR_PACKET_VIEW
+
+#include <arpa/inet.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "header.h"
+#include "label.h"
+#include "question.h"
+
+#define ISR_VIEW_HOPS 32
+#define ISR_VIEW_LABELS 127 /* the most a 255 octet name can have */
+#define ISR_VIEW_UDP_SIZE 512 /* without EDNS */
+
+/*
+	A parsed query that only points into the receive buffer.
+	It is meant to live on the stack, so parsing a query allocates nothing;
+	the dotted qname is only produced when someone asks for it.
+	Parsing folds the qname once: lower, labels and label_hashes are what
+	the name arena needs to find it without looking at its bytes again.
+*/
+struct packet_view {
+	unsigned char *packet;
+	size_t size;
+	struct header header;
+	size_t qname_offset; /* wire form, e.g. 7 e x a m p l e 3 c o m 0 */
+	size_t qname_length; /* including the terminating zero octet */
+	uint16_t qtype;
+	uint16_t qclass;
+	size_t question_length;
+	unsigned char lower[256 + ISR_LABEL_SLACK]; /* lowercased wire form of the qname */
+	uint8_t labels[ISR_VIEW_LABELS]; /* offset of each label's length octet in lower */
+	uint32_t label_hashes[ISR_VIEW_LABELS];
+	size_t labels_length;
+	uint32_t hash; /* of the whole qname, as the name arena hashes it */
+	bool edns; /* the query had an OPT record */
+	uint16_t udp_size; /* largest response the client takes over UDP */
+	uint8_t edns_version;
+	bool dnssec_ok; /* the DO bit */
+	size_t opt_offset; /* of the whole OPT record in packet */
+	size_t opt_rdata; /* offset of the OPT options in packet */
+	uint16_t opt_rdlength;
+	struct client_subnet subnet; /* the ECS option, subnet.ecs being false if there was none */
+	bool qname_ready;
+	char qname[256];
+};
+
+bool isr_view_parse(struct packet_view *view, unsigned char *packet, size_t size);
+
+const char *isr_view_qname(struct packet_view *view);
+
+bool isr_view_name(const unsigned char *packet, size_t size, size_t *offset, char *name);
+
+bool isr_view_opt(struct packet_view *view);
+
+bool isr_view_ecs(struct packet_view *view);
+
+bool isr_view_ttls(struct packet_view *view, uint16_t *ttl_offsets, size_t *ttl_offsets_length, size_t capacity);
+
+#endif
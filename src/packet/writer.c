@@ -0,0 +1,408 @@
+/*
+		Copyright (C) 2023
+			Pribess (Heewon Cho)
+			Jhyub	(Janghyub Seo)
+		src/packet/writer.c
+*/
+
+#include "writer.h"
+
+void isr_writer_init(struct packet_writer *writer, unsigned char *buff, size_t size) {
+	writer->buff = buff;
+	writer->size = size;
+	writer->length = 0;
+	writer->truncated = false;
+	writer->invalid = false;
+	writer->ttl_offsets_length = 0;
+	writer->ttls_overflow = false;
+	writer->suffixes_length = 0;
+	memset(writer->suffixes, 0, sizeof(writer->suffixes));
+}
+
+/*
+	Counts are kept in the header itself and bumped as sections are written.
+*/
+void isr_writer_count(struct packet_writer *writer, size_t offset) {
+	uint16_t count = ntohs(*(uint16_t *)(writer->buff + offset));
+	*(uint16_t *)(writer->buff + offset) = htons(count + 1);
+}
+
+bool isr_writer_header(struct packet_writer *writer, struct header *header) {
+	if (writer->size < 12) {
+		writer->truncated = true;
+		return false;
+	}
+
+	unsigned char *rst = writer->buff;
+
+	*(uint16_t *)(rst + 0) = htons(header->id);
+
+	rst[2] = (header->qr << 7)
+		+ (header->opcode << 3)
+		+ (header->aa << 2)
+		+ (header->tc << 1)
+		+ (header->rd << 0);
+
+	rst[3] = (header->ra << 7)
+	+ (header->z << 4)
+	+ (header->rcode << 0);
+
+	*(uint16_t *)(rst + 4) = htons(header->qdcount);
+	*(uint16_t *)(rst + 6) = htons(header->ancount);
+	*(uint16_t *)(rst + 8) = htons(header->nscount);
+	*(uint16_t *)(rst + 10) = htons(header->arcount);
+
+	writer->length = 12;
+
+	return true;
+}
+
+/*
+	Compression
+
+	Every suffix of every name written so far is remembered by a case-insensitive hash,
+	computed from the rightmost label so that "www.example.com" and "mail.example.com"
+	hash "example.com" the same way. A candidate found by hash is then compared label by
+	label against what is actually in the buffer before a pointer to it is written.
+*/
+
+uint32_t isr_writer_label_hash(uint32_t hash, const unsigned char *label) {
+	hash ^= label[0];
+	hash *= 16777619u;
+
+	for (uint8_t i = 1; i <= label[0]; i++) {
+		hash ^= (unsigned char) tolower(label[i]);
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+/*
+	Collects the label offsets of an uncompressed wire name and the hash of every suffix.
+	Returns the number of labels.
+*/
+size_t isr_writer_suffix_hashes(const unsigned char *name, size_t *labels, uint32_t *hashes) {
+	size_t count = 0;
+
+	for (size_t cursor = 0; name[cursor] != 0; cursor += name[cursor] + 1) {
+		labels[count++] = cursor;
+	}
+
+	uint32_t hash = 2166136261u;
+	for (size_t i = count; i-- > 0;) {
+		hash = isr_writer_label_hash(hash, name + labels[i]);
+		hashes[i] = hash;
+	}
+
+	return count;
+}
+
+/*
+	Compares the name at offset in our own buffer, which may itself end in a pointer,
+	with an uncompressed wire name.
+*/
+bool isr_writer_suffix_equal(struct packet_writer *writer, uint16_t offset, const unsigned char *name) {
+	for (int hops = 0; hops < 64;) {
+		uint8_t labellen = writer->buff[offset];
+
+		if ((labellen & 0xC0) == 0xC0) {
+			offset = ((labellen & 0x3F) << 8) | writer->buff[offset + 1];
+			hops++;
+			continue;
+		}
+
+		if (labellen != name[0]) return false;
+		if (labellen == 0) return true;
+
+		for (uint8_t i = 1; i <= labellen; i++) {
+			if (tolower(writer->buff[offset + i]) != tolower(name[i])) return false;
+		}
+
+		offset += labellen + 1;
+		name += labellen + 1;
+	}
+
+	return false;
+}
+
+uint16_t isr_writer_suffix_find(struct packet_writer *writer, uint32_t hash, const unsigned char *name) {
+	for (size_t i = 0; i < ISR_WRITER_SUFFIXES; i++) {
+		struct writer_suffix *suffix = &writer->suffixes[(hash + i) % ISR_WRITER_SUFFIXES];
+
+		if (suffix->offset == 0) return 0;
+		if (suffix->hash == hash && isr_writer_suffix_equal(writer, suffix->offset, name)) return suffix->offset;
+	}
+
+	return 0;
+}
+
+void isr_writer_suffix_add(struct packet_writer *writer, uint32_t hash, size_t offset) {
+	/* Pointers only have 14 bits, and a table kept half empty keeps probing short */
+	if (offset > 0x3FFF || writer->suffixes_length >= ISR_WRITER_SUFFIXES / 2) return;
+
+	size_t i = hash % ISR_WRITER_SUFFIXES;
+	while (writer->suffixes[i].offset != 0) i = (i + 1) % ISR_WRITER_SUFFIXES;
+
+	writer->suffixes[i].hash = hash;
+	writer->suffixes[i].offset = offset;
+	writer->suffixes_length++;
+}
+
+/*
+	Remembers the suffixes of an uncompressed name already sitting at offset.
+*/
+void isr_writer_suffix_register(struct packet_writer *writer, size_t offset) {
+	size_t labels[128];
+	uint32_t hashes[128];
+	size_t count = isr_writer_suffix_hashes(writer->buff + offset, labels, hashes);
+
+	for (size_t i = 0; i < count; i++) {
+		isr_writer_suffix_add(writer, hashes[i], offset + labels[i]);
+	}
+}
+
+/*
+	Writes an uncompressed wire name (at most 255 octets) as compressed as possible.
+*/
+bool isr_writer_name_wire(struct packet_writer *writer, const unsigned char *name) {
+	size_t labels[128];
+	uint32_t hashes[128];
+	size_t count = isr_writer_suffix_hashes(name, labels, hashes);
+
+	size_t i;
+	uint16_t pointer = 0;
+	for (i = 0; i < count; i++) {
+		pointer = isr_writer_suffix_find(writer, hashes[i], name + labels[i]);
+		if (pointer != 0) break;
+	}
+
+	size_t prefix = i < count ? labels[i] : (count == 0 ? 0 : labels[count - 1] + name[labels[count - 1]] + 1);
+	if (writer->length + prefix + (pointer != 0 ? 2 : 1) > writer->size) return false;
+
+	memcpy(writer->buff + writer->length, name, prefix);
+	for (size_t j = 0; j < i; j++) {
+		isr_writer_suffix_add(writer, hashes[j], writer->length + labels[j]);
+	}
+	writer->length += prefix;
+
+	if (pointer != 0) {
+		writer->buff[writer->length++] = 0xC0 | (pointer >> 8);
+		writer->buff[writer->length++] = pointer & 0xFF;
+	} else {
+		writer->buff[writer->length++] = 0;
+	}
+
+	return true;
+}
+
+/*
+	Writes a dotted name such as "example.com", whose wire form is 7 e x a m p l e 3 c o m 0.
+	A name that isn't valid marks the writer invalid, rather than out of room.
+*/
+bool isr_writer_name(struct packet_writer *writer, const char *name) {
+	unsigned char wire[ISR_WRITER_NAME_MAX];
+	size_t cursor = 0;
+	size_t labelstart = 0;
+
+	for (size_t i = 0; true; i++) {
+		if (name[i] != '.' && name[i] != '\0') continue;
+
+		size_t labellen = i - labelstart;
+		if (labellen > 63) goto invalid;
+
+		/* the root name and a trailing dot end with an empty label, which is the terminator itself */
+		if (labellen > 0) {
+			if (cursor + 1 + labellen + 1 > sizeof(wire)) goto invalid;
+
+			wire[cursor++] = labellen;
+			memcpy(wire + cursor, name + labelstart, labellen);
+			cursor += labellen;
+		}
+
+		labelstart = i + 1;
+		if (name[i] == '\0') break;
+	}
+	wire[cursor] = 0;
+
+	return isr_writer_name_wire(writer, wire);
+
+invalid:
+	writer->invalid = true;
+	return false;
+}
+
+bool isr_writer_question(struct packet_writer *writer, struct question *question) {
+	if (writer->truncated) return false;
+
+	size_t start = writer->length;
+
+	if (!isr_writer_name(writer, question->qname) || writer->length + 4 > writer->size) {
+		writer->length = start;
+		if (!writer->invalid) writer->truncated = true;
+		return false;
+	}
+
+	*(uint16_t *)(writer->buff + writer->length) = htons(question->qtype);
+	*(uint16_t *)(writer->buff + writer->length + 2) = htons(question->qclass);
+	writer->length += 4;
+
+	isr_writer_count(writer, 4);
+
+	return true;
+}
+
+/*
+	Copies a question already in uncompressed wire form, e.g. straight out of the query.
+*/
+bool isr_writer_question_wire(struct packet_writer *writer, const unsigned char *wire, size_t length) {
+	if (writer->truncated) return false;
+
+	if (writer->length + length > writer->size) {
+		writer->truncated = true;
+		return false;
+	}
+
+	memcpy(writer->buff + writer->length, wire, length);
+	isr_writer_suffix_register(writer, writer->length);
+	writer->length += length;
+
+	isr_writer_count(writer, 4);
+
+	return true;
+}
+
+/*
+	Length of the uncompressed wire name at the start of rdata, 0 if there is none.
+*/
+size_t isr_writer_rdata_name(const unsigned char *rdata, size_t rdlength) {
+	size_t cursor = 0;
+
+	while (cursor < rdlength) {
+		uint8_t labellen = rdata[cursor];
+		if (labellen == 0) return cursor + 1 > 255 ? 0 : cursor + 1;
+		if (labellen > 63) return 0;
+		cursor += labellen + 1;
+	}
+
+	return 0;
+}
+
+/*
+	RFC 1035 types may have the names in their RDATA compressed too (RFC 3597 section 4).
+	Anything we don't recognize, or that doesn't parse, is copied as is.
+*/
+bool isr_writer_rdata(struct packet_writer *writer, struct record *record) {
+	const unsigned char *rdata = record->rdata;
+	size_t rdlength = record->rdlength;
+
+	size_t names = 0;
+	size_t prefix = 0;
+	switch (record->type) {
+		case 2: case 3: case 4: case 5: case 7: case 8: case 9: case 12: /* NS MD MF CNAME MB MG MR PTR */
+			names = 1;
+			break;
+		case 15: /* MX */
+			names = 1;
+			prefix = 2;
+			break;
+		case 6: /* SOA */
+			names = 2;
+			break;
+	}
+
+	size_t cursor = prefix;
+	size_t lengths[2];
+	for (size_t i = 0; i < names; i++) {
+		lengths[i] = cursor <= rdlength ? isr_writer_rdata_name(rdata + cursor, rdlength - cursor) : 0;
+		if (lengths[i] == 0) { names = 0; break; }
+		cursor += lengths[i];
+	}
+
+	if (names == 0 || cursor > rdlength) {
+		if (writer->length + rdlength > writer->size) return false;
+
+		memcpy(writer->buff + writer->length, rdata, rdlength);
+		writer->length += rdlength;
+		return true;
+	}
+
+	if (writer->length + prefix > writer->size) return false;
+	memcpy(writer->buff + writer->length, rdata, prefix);
+	writer->length += prefix;
+
+	cursor = prefix;
+	for (size_t i = 0; i < names; i++) {
+		if (!isr_writer_name_wire(writer, rdata + cursor)) return false;
+		cursor += lengths[i];
+	}
+
+	if (writer->length + (rdlength - cursor) > writer->size) return false;
+	memcpy(writer->buff + writer->length, rdata + cursor, rdlength - cursor);
+	writer->length += rdlength - cursor;
+
+	return true;
+}
+
+bool isr_writer_record(struct packet_writer *writer, enum section section, struct record *record) {
+	if (writer->truncated) return false;
+
+	size_t start = writer->length;
+
+	if (record->name == NULL) {
+		/*
+			Since we only reply to one question (please refer to question.c),
+			the question name is always at index 12.
+		*/
+		if (writer->length + 2 > writer->size) goto truncate;
+		writer->buff[writer->length++] = 0xC0;
+		writer->buff[writer->length++] = 0x0C;
+	} else if (!isr_writer_name(writer, record->name)) {
+		goto truncate;
+	}
+
+	if (writer->length + 10 > writer->size) goto truncate;
+
+	unsigned char *rst = writer->buff + writer->length;
+	size_t ttl_offset = writer->length + 4;
+	size_t rdlength_offset = writer->length + 8;
+
+	*(uint16_t *)(rst + 0) = htons(record->type);
+	*(uint16_t *)(rst + 2) = htons(record->class);
+	*(uint32_t *)(rst + 4) = htonl(record->ttl);
+	writer->length += 10;
+
+	size_t rdata_start = writer->length;
+	if (!isr_writer_rdata(writer, record)) goto truncate;
+	*(uint16_t *)(writer->buff + rdlength_offset) = htons(writer->length - rdata_start);
+
+	/* OPT borrows the TTL field for flags, which must not age */
+	if (record->type != 41) {
+		if (writer->ttl_offsets_length < ISR_WRITER_TTLS) {
+			writer->ttl_offsets[writer->ttl_offsets_length++] = ttl_offset;
+		} else {
+			writer->ttls_overflow = true;
+		}
+	}
+
+	isr_writer_count(writer, 6 + 2 * section);
+
+	return true;
+
+truncate:
+	/* suffixes registered past start are left behind, but nothing is written after truncation anyway */
+	writer->length = start;
+	if (!writer->invalid) writer->truncated = true;
+	return false;
+}
+
+/*
+	Returns the length of the message, setting TC if anything had to be left out.
+*/
+size_t isr_writer_finish(struct packet_writer *writer) {
+	if (writer->length < 12) return 0;
+
+	if (writer->truncated) writer->buff[2] |= 0x02;
+
+	return writer->length;
+}
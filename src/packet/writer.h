@@ -0,0 +1,71 @@
+/*
+		Copyright (C) 2023
+			Pribess (Heewon Cho)
+			Jhyub	(Janghyub Seo)
+		src/packet/writer.h
+*/
+
+#ifndef ISR_PACKET_WRITER
+#define ISR_PACKET_WRITER
+
+#include <arpa/inet.h>
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "answer.h"
+#include "header.h"
+#include "question.h"
+
+#define ISR_WRITER_TTLS 255
+#define ISR_WRITER_NAME_MAX 255 /* octets of a wire name, RFC 1035 2.3.4 */
+#define ISR_WRITER_SUFFIXES 128
+
+enum section { ANSWER_SECTION, AUTHORITY_SECTION, ADDITIONAL_SECTION };
+
+struct writer_suffix {
+	uint32_t hash;
+	uint16_t offset; /* 0 meaning empty, no name can start inside the header */
+};
+
+/*
+	Writes a whole message straight into a caller provided buffer.
+	Sections have to be written in order: header, question, then records.
+	A record that doesn't fit is dropped along with every record after it,
+	and the TC bit is set when the message is finished.
+	A record whose name isn't a valid domain name is dropped too, but marks the
+	message invalid instead: it isn't the client's answer to shorten.
+	Names are compressed against every suffix written before them.
+*/
+struct packet_writer {
+	unsigned char *buff;
+	size_t size;
+	size_t length;
+	bool truncated;
+	bool invalid; /* a name given wasn't a valid domain name */
+	uint16_t ttl_offsets[ISR_WRITER_TTLS];
+	size_t ttl_offsets_length;
+	bool ttls_overflow; /* more TTLs than we can track, so the message can't be cached */
+	struct writer_suffix suffixes[ISR_WRITER_SUFFIXES];
+	size_t suffixes_length;
+};
+
+void isr_writer_init(struct packet_writer *writer, unsigned char *buff, size_t size);
+
+bool isr_writer_header(struct packet_writer *writer, struct header *header);
+
+bool isr_writer_name(struct packet_writer *writer, const char *name);
+
+bool isr_writer_name_wire(struct packet_writer *writer, const unsigned char *name);
+
+bool isr_writer_question(struct packet_writer *writer, struct question *question);
+
+bool isr_writer_question_wire(struct packet_writer *writer, const unsigned char *wire, size_t length);
+
+bool isr_writer_record(struct packet_writer *writer, enum section section, struct record *record);
+
+size_t isr_writer_finish(struct packet_writer *writer);
+
+#endif
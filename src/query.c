@@ -0,0 +1,572 @@
+/*
+		Copyright (C) 2023
+			Pribess (Heewon Cho)
+			Jhyub	(Janghyub Seo)
+		src/query.c
+*/
+
+#include "query.h"
+
+/*
+	One generation of scripts: isr.js bound, the state providers it registered and, once
+	a reload retires it, the modules it imported. The generation answering holds a
+	reference to it, and so does every query parked on a promise it returned, so that
+	the promise is settled against the scripts that made it.
+*/
+struct query_scripts {
+	struct script_bindings *bindings;
+	struct state_provider **providers;
+	size_t providers_size;
+	struct module_registry registry; /* empty while current, its modules being in the global registry */
+	size_t refs;
+};
+
+struct query_scripts *isr_query_scripts;
+
+struct query_scripts *isr_query_scripts_new(struct script_bindings *bindings) {
+	struct query_scripts *ret = calloc(1, sizeof(struct query_scripts));
+	ret->bindings = bindings;
+	ret->providers = isr_script_state_providers(&ret->providers_size);
+	ret->refs = 1;
+
+	return ret;
+}
+
+void isr_query_scripts_release(struct query_scripts *scripts) {
+	if (--scripts->refs > 0) return;
+
+	isr_script_state_providers_free(scripts->providers, scripts->providers_size);
+	isr_script_unbind(scripts->bindings);
+	isr_module_registry_free(&scripts->registry);
+	free(scripts);
+}
+
+bool isr_query_init() {
+	jerry_value_t module = isr_script_load();
+	if (jerry_value_is_exception(module)) {
+		isr_script_report(module);
+		return false;
+	}
+
+	struct script_bindings *bindings = isr_script_bind(module);
+	if (bindings == NULL) return false;
+
+	isr_query_scripts = isr_query_scripts_new(bindings);
+
+	isr_query_templates(isr_query_scripts->bindings);
+
+	return true;
+}
+
+/*
+	Loads isr.js and everything it imports afresh, into a registry of their own,
+	and swaps the result in for the scripts answering now. Queries are handled one
+	at a time, so none is in flight while this runs and none is dropped. Queries
+	parked on a promise keep the previous scripts alive until they resume, and
+	are answered without caching anything, like those forwarded before the swap.
+	The previous scripts keep answering if the new ones fail to load.
+	Everything cached from the previous scripts' decisions goes with them.
+*/
+bool isr_query_reload() {
+	struct module_registry previous = { 0 };
+	isr_module_registry_swap(&previous);
+
+	jerry_value_t module = isr_script_load();
+	if (jerry_value_is_exception(module)) {
+		isr_script_report(module);
+		goto restore;
+	}
+
+	struct script_bindings *bindings = isr_script_bind(module);
+	if (bindings == NULL) goto restore;
+
+	isr_query_scripts->registry = previous;
+	isr_query_scripts_release(isr_query_scripts);
+	isr_query_scripts = isr_query_scripts_new(bindings);
+
+	isr_decision_flush();
+	isr_response_cache_flush();
+	isr_forward_uncache();
+	isr_query_templates(isr_query_scripts->bindings);
+
+	return true;
+
+restore:
+	isr_module_registry_clear();
+	isr_module_registry_swap(&previous);
+
+	return false;
+}
+
+/*
+	Only answers that don't depend on state may outlive the decision that produced them,
+	both in our response cache and in downstream caches.
+*/
+uint32_t isr_query_ttl(struct resolve_result *result) {
+	if (result->hint == NULL || result->hint->depends == NULL || result->hint->depends_length != 0) return 0;
+
+	return result->hint->ttl;
+}
+
+struct header isr_query_response_header(struct header *req_header, unsigned char rcode) {
+	struct header header = {
+		.id = req_header->id,
+		.qr = 1,
+		.opcode = req_header->opcode,
+		.aa = 0,
+		.tc = 0,
+		.rd = req_header->rd,
+		.ra = 1,
+		.z = 0,
+		.rcode = rcode,
+		.qdcount = 0,
+		.ancount = 0,
+		.nscount = 0,
+		.arcount = 0,
+	};
+
+	return header;
+}
+
+void isr_query_records(struct packet_writer *writer, struct packet_view *view, enum section section, struct resolve_result_record *records, size_t records_length, uint32_t ttl) {
+	for (size_t i = 0; i < records_length; i++) {
+		struct resolve_result_record *from = &records[i];
+
+		struct record record = {
+			.name = from->name,
+			.type = from->type,
+			.class = view->qclass,
+			.ttl = from->has_ttl ? from->ttl : ttl,
+			.rdlength = from->rdlength,
+			.rdata = from->rdata,
+		};
+
+		isr_writer_record(writer, section, &record);
+	}
+}
+
+size_t isr_query_error(struct packet_writer *writer, struct packet_view *view, unsigned char rcode) {
+	struct header header = isr_query_response_header(&view->header, rcode);
+
+	isr_writer_header(writer, &header);
+	isr_writer_question_wire(writer, view->packet + 12, view->question_length);
+
+	return isr_writer_finish(writer);
+}
+
+/*
+	Writes every record of answer, records without their own ttl getting ttl.
+	Additional records are only nice to have, so leaving some out doesn't set TC (RFC 2181 9).
+*/
+size_t isr_query_answer(struct packet_writer *writer, struct packet_view *view, struct resolve_result_answer *answer, uint32_t ttl) {
+	struct header header = isr_query_response_header(&view->header, answer->rcode);
+
+	isr_writer_header(writer, &header);
+	isr_writer_question_wire(writer, view->packet + 12, view->question_length);
+
+	isr_query_records(writer, view, ANSWER_SECTION, answer->records, answer->records_length, ttl);
+	isr_query_records(writer, view, AUTHORITY_SECTION, answer->authority, answer->authority_length, ttl);
+
+	bool truncated = writer->truncated;
+	isr_query_records(writer, view, ADDITIONAL_SECTION, answer->additional, answer->additional_length, ttl);
+	writer->truncated = truncated;
+
+	/* A record name the script got wrong is a server failure, not something to truncate */
+	if (writer->invalid) {
+		isr_writer_init(writer, writer->buff, writer->size);
+		writer->invalid = true;
+		return isr_query_error(writer, view, 2);
+	}
+
+	return isr_writer_finish(writer);
+}
+
+/*
+	Answers a query we couldn't read (FORMERR) or won't (NOTIMP) with a bare header,
+	since there may be no question worth echoing.
+*/
+size_t isr_query_reject(unsigned char *resp, size_t resp_size, struct header *req_header, unsigned char rcode) {
+	struct packet_writer writer;
+	isr_writer_init(&writer, resp, resp_size);
+
+	struct header header = isr_query_response_header(req_header, rcode);
+	isr_writer_header(&writer, &header);
+
+	return isr_writer_finish(&writer);
+}
+
+/*
+	Appends our OPT record to the response of length in resp, if the query had one.
+	Responses are cached without it, so it is added to every response on its way out.
+	A query with ECS gets it back with the scope the answer was given for (RFC 7871 7.2.1).
+*/
+size_t isr_query_opt(struct packet_view *view, unsigned char *resp, size_t resp_size, size_t length, uint8_t scope) {
+	if (!view->edns || length == 0) return length;
+
+	unsigned char options[ISR_QUERY_ECS_LENGTH];
+	uint16_t options_length = 0;
+
+	if (view->subnet.ecs) {
+		size_t bytes = (view->subnet.prefix + 7) / 8;
+
+		*(uint16_t *)(options + 0) = htons(8);
+		*(uint16_t *)(options + 2) = htons(4 + bytes);
+		*(uint16_t *)(options + 4) = htons(view->subnet.family);
+		options[6] = view->subnet.prefix;
+		options[7] = scope;
+		memcpy(options + 8, view->subnet.address, bytes);
+
+		options_length = 8 + bytes;
+	}
+
+	struct packet_writer writer;
+	isr_writer_init(&writer, resp, resp_size);
+	writer.length = length;
+
+	struct record record = {
+		.name = "",
+		.type = 41,
+		.class = ISR_QUERY_UDP_SIZE,
+		.ttl = 0,
+		.rdlength = options_length,
+		.rdata = options,
+	};
+
+	if (!isr_writer_record(&writer, ADDITIONAL_SECTION, &record)) return length;
+
+	return writer.length;
+}
+
+/*
+	Whether record is owned by name itself, rather than being further down a chain.
+*/
+bool isr_query_template_owned(struct resolve_result_record *record, const char *name) {
+	if (record->name == NULL) return true;
+
+	size_t length = strlen(name);
+	return strncasecmp(record->name, name, length) == 0 && (record->name[length] == '\0' || strcmp(record->name + length, ".") == 0);
+}
+
+/*
+	Compiles the response to name and qtype out of answer: the records of that type owned
+	by name, along with any owned by other names, and all of its authority and additional records.
+	It is written once, through the same path as any other answer,
+	for a query made up from name and qtype.
+*/
+void isr_query_template(char *name, uint16_t qtype, struct resolve_result_answer *answer, uint32_t ttl) {
+	struct resolve_result_answer typed = *answer;
+	typed.records = malloc(answer->records_length * sizeof(struct resolve_result_record));
+	typed.records_length = 0;
+
+	for (size_t i = 0; i < answer->records_length; i++) {
+		struct resolve_result_record *record = &answer->records[i];
+		if (record->type == qtype || !isr_query_template_owned(record, name)) typed.records[typed.records_length++] = *record;
+	}
+
+	struct question question = {
+		.qname = name,
+		.qtype = qtype,
+		.qclass = 1,
+		.name = NULL,
+	};
+
+	unsigned char query[512];
+	struct packet_writer writer;
+	isr_writer_init(&writer, query, sizeof(query));
+
+	struct header header = { .rd = 1, .qdcount = 0 };
+	isr_writer_header(&writer, &header);
+	isr_writer_question(&writer, &question);
+
+	struct packet_view view;
+	if (!isr_view_parse(&view, query, isr_writer_finish(&writer))) goto free_records;
+
+	unsigned char resp[ISR_QUERY_UDP_SIZE - ISR_QUERY_OPT_LENGTH];
+	isr_writer_init(&writer, resp, sizeof(resp));
+
+	size_t length = isr_query_answer(&writer, &view, &typed, ttl);
+	if (length > 0 && !writer.truncated && !writer.invalid) isr_template_store(&question, resp, length, view.question_length);
+
+free_records:
+	free(typed.records);
+}
+
+/*
+	Compiles the static answers of the bound isr.js into response templates, dropping the old ones.
+	An answer holding records of several types for its name gets a template for each type.
+*/
+void isr_query_templates(struct script_bindings *bindings) {
+	isr_template_flush();
+
+	size_t answers_size;
+	struct static_answer *answers = isr_script_static_answers(bindings, &answers_size);
+
+	for (size_t i = 0; i < answers_size; i++) {
+		struct resolve_result *result = answers[i].result;
+		struct resolve_result_answer *answer = result->value.answer;
+		uint32_t ttl = result->hint != NULL ? result->hint->ttl : 0;
+
+		for (size_t j = 0; j < answer->records_length; j++) {
+			struct resolve_result_record *record = &answer->records[j];
+			if (!isr_query_template_owned(record, answers[i].name)) continue;
+
+			/* Only the first record of each type */
+			size_t k = 0;
+			while (k < j && (answer->records[k].type != record->type || !isr_query_template_owned(&answer->records[k], answers[i].name))) k++;
+			if (k < j) continue;
+
+			isr_query_template(answers[i].name, record->type, answer, ttl);
+		}
+
+		isr_resolve_result_free(result);
+		free(answers[i].name);
+	}
+
+	free(answers);
+}
+
+/*
+	Works out how much of resp the answer may take, keeping room for our own OPT,
+	and fills in question and subnet for the query in view.
+	The name of the question is retained, for the whole query, as resolve() may drop
+	cache entries and with them the name.
+*/
+size_t isr_query_prepare(struct packet_view *view, struct query_source *source, size_t resp_size, struct client_subnet *subnet, struct question *question) {
+	size_t limit = view->udp_size < ISR_QUERY_UDP_SIZE ? view->udp_size : ISR_QUERY_UDP_SIZE;
+	if (limit > resp_size) limit = resp_size;
+	if (view->edns) limit -= ISR_QUERY_OPT_LENGTH + (view->subnet.ecs ? ISR_QUERY_ECS_LENGTH : 0);
+
+	/* Behind a forwarder the client is whoever ECS says it is, otherwise it is our peer */
+	*subnet = view->subnet;
+	if (!subnet->ecs) {
+		subnet->family = ISR_SUBNET_IPV4;
+		subnet->prefix = 32;
+		subnet->scope = 0;
+		memcpy(subnet->address, &source->peer.sin_addr, 4);
+	}
+
+	struct name *name = isr_name_find_wire(view->lower, view->labels, view->label_hashes, view->labels_length);
+	if (name != NULL) isr_name_retain(name);
+
+	*question = (struct question) {
+		.qname = (char *) isr_view_qname(view),
+		.qtype = view->qtype,
+		.qclass = view->qclass,
+		.name = name,
+		.subnet = subnet,
+		.source = source,
+		.view = view,
+	};
+
+	return limit;
+}
+
+/*
+	Writes the response for result, settled, to resp and frees it, along with the query's name.
+	The response (or the reply to a forwarded query) is cached only if store is set.
+	Returns the length of the response, 0 meaning it was forwarded.
+*/
+size_t isr_query_respond(struct packet_view *view, struct question *question, struct resolve_result *result, unsigned char *resp, size_t resp_size, size_t limit, bool store) {
+	size_t ret;
+
+	struct packet_writer writer;
+	isr_writer_init(&writer, resp, limit);
+
+	uint8_t scope = result->hint != NULL ? result->hint->scope : 0;
+
+	if (result->type == ANSWER) {
+		uint32_t ttl = isr_query_ttl(result);
+
+		ret = isr_query_answer(&writer, view, result->value.answer, ttl);
+
+		if (store && ttl > 0 && ret > 0 && !writer.truncated && !writer.invalid && !writer.ttls_overflow) {
+			unsigned char *wire = malloc(ret * sizeof(unsigned char));
+			memcpy(wire, resp, ret);
+
+			if (isr_response_cache_store(question, scope, wire, ret, view->question_length, writer.ttl_offsets, writer.ttl_offsets_length) == NULL) free(wire);
+		}
+	} else if (result->type == FORWARD && isr_forward_query(view, result->value.forward->ip, question->source, store && isr_query_ttl(result) > 0)) {
+		ret = 0;
+	} else {
+		ret = isr_query_error(&writer, view, 2);
+	}
+
+	isr_resolve_result_free(result);
+	if (question->name != NULL) isr_name_release(question->name);
+
+	return isr_query_opt(view, resp, resp_size, ret, scope);
+}
+
+/*
+	Queries whose resolve() returned a promise wait here, each with a copy of its request,
+	until the promise settles or ISR_QUERY_PARK_TIMEOUT passes.
+*/
+
+struct parked_query {
+	struct parked_query *next;
+	jerry_value_t promise;
+	struct query_scripts *scripts; /* those resolve() was called on */
+	struct query_source source;
+	uint64_t expire;
+	size_t size;
+	unsigned char req[];
+};
+
+struct parked_query *isr_query_parked = NULL;
+size_t isr_query_parked_size = 0;
+
+size_t isr_query_parked_count() {
+	return isr_query_parked_size;
+}
+
+void isr_query_park(unsigned char *req, size_t req_size, struct query_source *source, jerry_value_t promise) {
+	struct parked_query *parked = malloc(sizeof(struct parked_query) + req_size);
+	parked->promise = jerry_value_copy(promise);
+	parked->scripts = isr_query_scripts;
+	parked->scripts->refs++;
+	parked->source = *source;
+	parked->expire = isr_clock_ms() + ISR_QUERY_PARK_TIMEOUT;
+	parked->size = req_size;
+	memcpy(parked->req, req, req_size);
+
+	parked->next = isr_query_parked;
+	isr_query_parked = parked;
+	isr_query_parked_size++;
+}
+
+/*
+	Finishes one parked query whose promise has settled, or that waited too long and gets SERVFAIL.
+	Returns false if there is none, else writes its response to resp, its length to *length
+	(0 meaning nothing should be sent back) and where it goes to *source.
+*/
+bool isr_query_resume(unsigned char *resp, size_t resp_size, size_t *length, struct query_source *source) {
+	if (isr_query_parked_size == 0) return false;
+
+	uint64_t now = isr_clock_ms();
+
+	struct parked_query **link = &isr_query_parked;
+	while (*link != NULL && jerry_promise_state((*link)->promise) == JERRY_PROMISE_STATE_PENDING && now < (*link)->expire) {
+		link = &(*link)->next;
+	}
+	if (*link == NULL) return false;
+
+	struct parked_query *parked = *link;
+	*link = parked->next;
+	isr_query_parked_size--;
+
+	*source = parked->source;
+
+	struct packet_view view;
+	isr_view_parse(&view, parked->req, parked->size);
+
+	struct client_subnet subnet;
+	struct question question;
+	size_t limit = isr_query_prepare(&view, source, resp_size, &subnet, &question);
+
+	/* A query parked before a reload is still answered, but what the previous scripts decided isn't cached */
+	bool store = parked->scripts == isr_query_scripts;
+
+	struct resolve_result *result;
+	if (jerry_promise_state(parked->promise) == JERRY_PROMISE_STATE_PENDING) {
+		jerry_value_free(parked->promise);
+		result = isr_result_fallback(jerry_throw_value(jerry_string_sz("resolve() didn't settle in time"), true));
+	} else {
+		result = isr_script_result(parked->scripts->bindings, &question, parked->promise, parked->scripts->providers, parked->scripts->providers_size, store);
+	}
+
+	*length = isr_query_respond(&view, &question, result, resp, resp_size, limit, store);
+
+	isr_query_scripts_release(parked->scripts);
+	free(parked);
+
+	return true;
+}
+
+/*
+	Handles whatever the query in packet needs no script for, writing the response to packet->resp.
+	Returns false if resolve() has to decide it, with slot prepared for that, else true.
+*/
+bool isr_query_begin(struct query_packet *packet, struct query_slot *slot) {
+	size_t ret = 0;
+	size_t resp_size = sizeof(packet->resp);
+	struct packet_view *view = &slot->view;
+
+	packet->resp_length = 0;
+
+	if (packet->req_size < 12) return true;
+	if (!isr_view_parse(view, packet->req, packet->req_size)) {
+		if (view->header.qr != 0) return true;
+		packet->resp_length = isr_query_reject(packet->resp, resp_size, &view->header, view->header.opcode != 0 ? 4 : 1);
+		return true;
+	}
+	if (view->header.qr != 0) return true;
+	if (view->header.opcode != 0) {
+		packet->resp_length = isr_query_reject(packet->resp, resp_size, &view->header, 4);
+		return true;
+	}
+
+	slot->limit = isr_query_prepare(view, &packet->source, resp_size, &slot->subnet, &slot->question);
+
+	struct response_template *template = isr_template_lookup(&slot->question);
+	if (template != NULL && (ret = isr_template_serve(template, packet->req, packet->resp, slot->limit)) > 0) {
+		if (slot->question.name != NULL) isr_name_release(slot->question.name);
+		packet->resp_length = isr_query_opt(view, packet->resp, resp_size, ret, 0);
+		return true;
+	}
+
+	/* An entry too large for this client is a miss, rather than a truncated answer */
+	struct cached_response *cached = isr_response_cache_lookup(&slot->question);
+	if (cached != NULL && (ret = isr_response_cache_serve(cached, packet->req, packet->resp, slot->limit)) > 0) {
+		if (slot->question.name != NULL) isr_name_release(slot->question.name);
+		packet->resp_length = isr_query_opt(view, packet->resp, resp_size, ret, cached->scope.prefix);
+		return true;
+	}
+
+	return false;
+}
+
+/*
+	Slots of the queries in a batch that resolve() has to decide.
+*/
+struct query_slot isr_query_slots[ISR_QUERY_BATCH];
+
+/*
+	Handles the count queries received together in packets, writing each response
+	to its packet. Those the templates and the response cache can't answer are
+	handed to the script in one go, so that isr.js decides them with one call to
+	resolveBatch() if it exports it.
+	A resp_length of 0 means nothing should be sent back (yet) for that packet.
+*/
+void isr_query_handle_batch(struct query_packet *packets, size_t count) {
+	struct question *questions[ISR_QUERY_BATCH];
+	struct resolve_result *results[ISR_QUERY_BATCH];
+	size_t indexes[ISR_QUERY_BATCH];
+	size_t undecided = 0;
+
+	if (count > ISR_QUERY_BATCH) count = ISR_QUERY_BATCH;
+
+	for (size_t i = 0; i < count; i++) {
+		if (isr_query_begin(&packets[i], &isr_query_slots[undecided])) continue;
+
+		questions[undecided] = &isr_query_slots[undecided].question;
+		indexes[undecided++] = i;
+	}
+
+	if (undecided == 0) return;
+
+	isr_script_run_batch(isr_query_scripts->bindings, questions, undecided, isr_query_scripts->providers, isr_query_scripts->providers_size, results);
+
+	for (size_t i = 0; i < undecided; i++) {
+		struct query_packet *packet = &packets[indexes[i]];
+		struct query_slot *slot = &isr_query_slots[i];
+
+		if (results[i]->type == PENDING) {
+			isr_query_park(packet->req, packet->req_size, &packet->source, results[i]->value.promise);
+			isr_resolve_result_free(results[i]);
+			if (slot->question.name != NULL) isr_name_release(slot->question.name);
+			continue;
+		}
+
+		packet->resp_length = isr_query_respond(&slot->view, &slot->question, results[i], packet->resp, sizeof(packet->resp), slot->limit, true);
+	}
+}
@@ -0,0 +1,69 @@
+/*
+		Copyright (C) 2023
+			Pribess (Heewon Cho)
+			Jhyub	(Janghyub Seo)
+		src/query.h
+*/
+
+#ifndef ISR_QUERY
+#define ISR_QUERY
+
+#include <jerryscript.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "forward.h"
+#include "cache/decision.h"
+#include "cache/response.h"
+#include "cache/template.h"
+#include "packet/answer.h"
+#include "packet/header.h"
+#include "packet/question.h"
+#include "packet/view.h"
+#include "packet/writer.h"
+#include "script/engine.h"
+#include "script/state.h"
+
+#define ISR_QUERY_UDP_SIZE 1232 /* what we advertise and answer with at most, as DNS flag day 2020 suggests */
+#define ISR_QUERY_OPT_LENGTH 11 /* an OPT record without options */
+#define ISR_QUERY_ECS_LENGTH 24 /* the most an ECS option takes, for an IPv6 /128 */
+#define ISR_QUERY_PARK_TIMEOUT 5000 /* ms an async resolve() has to settle */
+#define ISR_QUERY_BATCH 32 /* datagrams received and handled together at most */
+
+/*
+	A query received, along with the response written for it.
+*/
+struct query_packet {
+	unsigned char req[4096];
+	size_t req_size;
+	unsigned char resp[ISR_QUERY_UDP_SIZE];
+	size_t resp_length;
+	struct query_source source;
+};
+
+/*
+	What a query left to resolve() needs to be answered once it is decided.
+*/
+struct query_slot {
+	struct packet_view view;
+	struct client_subnet subnet;
+	struct question question;
+	size_t limit;
+};
+
+bool isr_query_init();
+
+bool isr_query_reload();
+
+void isr_query_templates(struct script_bindings *bindings);
+
+void isr_query_handle_batch(struct query_packet *packets, size_t count);
+
+bool isr_query_resume(unsigned char *resp, size_t resp_size, size_t *length, struct query_source *source);
+
+size_t isr_query_parked_count();
+
+#endif
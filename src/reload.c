@@ -0,0 +1,49 @@
+/*
+		Copyright (C) 2023
+			Pribess (Heewon Cho)
+			Jhyub	(Janghyub Seo)
+		src/reload.c
+*/
+
+#include "reload.h"
+
+extern struct config isr_config;
+
+/*
+	Watches getter_script_dir for scripts written, moved or deleted.
+	Only finished writes count, so a script is never loaded half saved.
+*/
+int isr_reload_open() {
+	if (!isr_config.script_reload) return -1;
+
+	int reloadfd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (reloadfd < 0) {
+		perror("isr: inotify");
+		return -1;
+	}
+
+	if (inotify_add_watch(reloadfd, isr_config.getter_script_dir, IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE) < 0) {
+		perror("isr: inotify");
+		close(reloadfd);
+		return -1;
+	}
+
+	return reloadfd;
+}
+
+/*
+	Drains every pending event first, so saving several scripts at once reloads once.
+*/
+void isr_reload_handle(int reloadfd) {
+	char buff[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+
+	bool changed = false;
+	while (read(reloadfd, buff, sizeof(buff)) > 0) changed = true;
+	if (!changed) return;
+
+	if (isr_query_reload()) {
+		printf("isr: reloaded %s\n", isr_config.getter_script_dir);
+	} else {
+		printf("isr: failed to reload %s, keeping the previous scripts\n", isr_config.getter_script_dir);
+	}
+}
@@ -0,0 +1,23 @@
+/*
+		Copyright (C) 2023
+			Pribess (Heewon Cho)
+			Jhyub	(Janghyub Seo)
+		src/reload.h
+*/
+
+#ifndef ISR_RELOAD
+#define ISR_RELOAD
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+#include "config.h"
+#include "query.h"
+
+int isr_reload_open();
+
+void isr_reload_handle(int reloadfd);
+
+#endif
@@ -6,24 +6,161 @@
 */
 
 #include "engine.h"
+#include "../cache/decision.h"
 
-unsigned char *isr_from_jerry_typedarray(jerry_value_t jerry_typedarray, uint16_t *length) {
-	unsigned char *ret;
+#define ISR_SCRIPT_HALT_INTERVAL 1024
 
-	jerry_length_t buff_len, buff_offset;
-	jerry_value_t buff = jerry_typedarray_buffer(jerry_typedarray, &buff_offset, &buff_len);
-	if (jerry_value_is_exception(buff)) { ret = NULL; goto free_buff; }
+extern struct config isr_config;
 
-	ret = malloc(buff_len * sizeof(unsigned char));
-	jerry_length_t readr = jerry_arraybuffer_read(buff, buff_offset, ret, buff_len);
-	*length = readr;
+char *isr_from_jerry_string(jerry_value_t jerry_string) {
+	jerry_size_t size = jerry_string_size(jerry_string, JERRY_ENCODING_UTF8);
 
-free_buff:
-	jerry_value_free(buff);
+	char *ret = malloc((size + 1) * sizeof(char));
+	jerry_size_t copied = jerry_string_to_buffer(jerry_string, JERRY_ENCODING_UTF8, (jerry_char_t *) ret, size);
+	ret[copied] = '\0';
 
 	return ret;
 }
 
+struct resolve_result_hint *isr_from_jerry_hint(struct script_bindings *bindings, jerry_value_t call_result) {
+	struct resolve_result_hint *ret = NULL;
+
+	jerry_value_t cache = jerry_object_get(call_result, bindings->strings[ISR_STRING_CACHE]);
+	if (!jerry_value_is_object(cache)) goto free_cache;
+
+	jerry_value_t ttl = jerry_object_get(cache, bindings->strings[ISR_STRING_TTL]);
+	if (!jerry_value_is_number(ttl)) goto free_ttl;
+
+	ret = malloc(sizeof(struct resolve_result_hint));
+	ret->ttl = jerry_value_as_uint32(ttl);
+	ret->depends = NULL;
+	ret->depends_length = 0;
+
+	jerry_value_t scope = jerry_object_get(cache, bindings->strings[ISR_STRING_SCOPE]);
+	uint32_t scope_bits = jerry_value_is_number(scope) ? jerry_value_as_uint32(scope) : 0;
+	ret->scope = scope_bits > 128 ? 128 : scope_bits;
+	jerry_value_free(scope);
+
+	jerry_value_t depends = jerry_object_get(cache, bindings->strings[ISR_STRING_DEPENDS]);
+	if (jerry_value_is_array(depends)) {
+		uint32_t length = jerry_array_length(depends);
+		ret->depends = malloc((length + 1) * sizeof(char *));
+
+		for (uint32_t i = 0; i < length; i++) {
+			jerry_value_t path = jerry_object_get_index(depends, i);
+			if (jerry_value_is_string(path)) {
+				ret->depends[ret->depends_length++] = isr_from_jerry_string(path);
+			}
+			jerry_value_free(path);
+		}
+	}
+	jerry_value_free(depends);
+
+free_ttl:
+	jerry_value_free(ttl);
+free_cache:
+	jerry_value_free(cache);
+
+	return ret;
+}
+
+void isr_resolve_result_records_free(struct resolve_result_record *records, size_t length) {
+	for (size_t i = 0; i < length; i++) {
+		free(records[i].name);
+		if (jerry_value_is_undefined(records[i].backing)) {
+			free(records[i].rdata);
+		} else {
+			jerry_value_free(records[i].backing);
+		}
+	}
+	free(records);
+}
+
+void isr_resolve_result_answer_free(struct resolve_result_answer *answer) {
+	isr_resolve_result_records_free(answer->records, answer->records_length);
+	isr_resolve_result_records_free(answer->authority, answer->authority_length);
+	isr_resolve_result_records_free(answer->additional, answer->additional_length);
+	free(answer);
+}
+
+struct resolve_result_record *isr_resolve_result_records_copy(struct resolve_result_record *records, size_t length) {
+	struct resolve_result_record *ret = malloc((length + 1) * sizeof(struct resolve_result_record));
+
+	for (size_t i = 0; i < length; i++) {
+		ret[i] = records[i];
+		ret[i].name = records[i].name != NULL ? strdup(records[i].name) : NULL;
+		ret[i].rdata = malloc(records[i].rdlength * sizeof(unsigned char));
+		memcpy(ret[i].rdata, records[i].rdata, records[i].rdlength);
+		ret[i].backing = jerry_undefined();
+	}
+
+	return ret;
+}
+
+struct resolve_result_hint *isr_resolve_result_hint_copy(struct resolve_result_hint *hint) {
+	if (hint == NULL) return NULL;
+
+	struct resolve_result_hint *ret = malloc(sizeof(struct resolve_result_hint));
+	*ret = *hint;
+
+	if (hint->depends != NULL) {
+		ret->depends = malloc((hint->depends_length + 1) * sizeof(char *));
+		for (size_t i = 0; i < hint->depends_length; i++) {
+			ret->depends[i] = strdup(hint->depends[i]);
+		}
+	}
+
+	return ret;
+}
+
+struct resolve_result *isr_resolve_result_copy(struct resolve_result *result) {
+	struct resolve_result *ret = malloc(sizeof(struct resolve_result));
+	ret->type = result->type;
+	ret->hint = isr_resolve_result_hint_copy(result->hint);
+
+	if (result->type == ANSWER) {
+		struct resolve_result_answer *from = result->value.answer;
+		struct resolve_result_answer *ans = malloc(sizeof(struct resolve_result_answer));
+
+		ans->rcode = from->rcode;
+		ans->records_length = from->records_length;
+		ans->records = isr_resolve_result_records_copy(from->records, from->records_length);
+		ans->authority_length = from->authority_length;
+		ans->authority = isr_resolve_result_records_copy(from->authority, from->authority_length);
+		ans->additional_length = from->additional_length;
+		ans->additional = isr_resolve_result_records_copy(from->additional, from->additional_length);
+
+		ret->value.answer = ans;
+	} else if (result->type == FORWARD) {
+		struct resolve_result_forward *fwd = malloc(sizeof(struct resolve_result_forward));
+		fwd->ip = strdup(result->value.forward->ip);
+		ret->value.forward = fwd;
+	}
+
+	return ret;
+}
+
+void isr_resolve_result_free(struct resolve_result *result) {
+	if (result->type == ANSWER) {
+		isr_resolve_result_answer_free(result->value.answer);
+	} else if (result->type == FORWARD) {
+		free(result->value.forward->ip);
+		free(result->value.forward);
+	} else if (result->type == PENDING) {
+		jerry_value_free(result->value.promise);
+	}
+
+	if (result->hint != NULL) {
+		for (size_t i = 0; i < result->hint->depends_length; i++) {
+			free(result->hint->depends[i]);
+		}
+		free(result->hint->depends);
+		free(result->hint);
+	}
+
+	free(result);
+}
+
 jerry_value_t isr_script_evaluate(const jerry_char_t *script, size_t script_size) {
 	jerry_value_t ret;
 
@@ -46,21 +183,216 @@ free_pre_evaluater:
 	return ret;
 }
 
-jerry_value_t isr_script_object_question(struct question *question) {
+/*
+	Loads isr.js from the getter script directory, which is where resolve() lives.
+*/
+jerry_value_t isr_script_load() {
+	jerry_value_t ret = isr_module_resolve_sz("isr.js");
+	if (jerry_value_is_exception(ret)) return ret;
+
+	return isr_module_instantiate(ret);
+}
+
+/*
+	Question objects carry the question they were made for as their native pointer.
+	Everything past name, type and class is read through getters on a prototype shared
+	by all of them, so a script only pays for what it looks at. A value is computed
+	on first read and then kept on the object itself.
+*/
+
+const jerry_object_native_info_t isr_script_question_info = { .free_cb = NULL };
+
+jerry_value_t isr_script_question_materialize(const jerry_call_info_t *call_info_p, const char *name, jerry_value_t value) {
+	jerry_property_descriptor_t desc = jerry_property_descriptor();
+	desc.flags = JERRY_PROP_IS_VALUE_DEFINED | JERRY_PROP_IS_ENUMERABLE_DEFINED | JERRY_PROP_IS_ENUMERABLE;
+	desc.value = value;
+
+	jerry_value_t namev = jerry_string_sz(name);
+	jerry_value_free(jerry_object_define_own_prop(call_info_p->this_value, namev, &desc));
+	jerry_value_free(namev);
+
+	return value;
+}
+
+jerry_value_t isr_script_address(struct in_addr *address) {
+	char buff[INET_ADDRSTRLEN];
+	inet_ntop(AF_INET, address, buff, sizeof(buff));
+
+	return jerry_string_sz(buff);
+}
+
+#define ISR_QUESTION_GETTER(field) \
+	jerry_value_t isr_script_question_##field(const jerry_call_info_t *call_info_p, const jerry_value_t args_p[], const jerry_length_t args_cnt) { \
+		struct question *question = jerry_object_get_native_ptr(call_info_p->this_value, &isr_script_question_info); \
+		if (question == NULL) return jerry_undefined(); \
+		return isr_script_question_materialize(call_info_p, #field, isr_script_question_get_##field(question)); \
+	}
+
+/*
+	{ address: "192.0.2.0", prefix: 24, family: 4, ecs: true }, the network the query is for.
+*/
+jerry_value_t isr_script_question_get_client(struct question *question) {
+	if (question->subnet == NULL) return jerry_undefined();
+
+	struct client_subnet *subnet = question->subnet;
 	jerry_value_t ret = jerry_object();
 
+	char address[INET6_ADDRSTRLEN];
+	inet_ntop(subnet->family == ISR_SUBNET_IPV6 ? AF_INET6 : AF_INET, subnet->address, address, sizeof(address));
+
+	jerry_value_t addressv = jerry_string_sz(address);
+	jerry_value_free(jerry_object_set_sz(ret, "address", addressv));
+	jerry_value_free(addressv);
+
+	jerry_value_t prefixv = jerry_number(subnet->prefix);
+	jerry_value_free(jerry_object_set_sz(ret, "prefix", prefixv));
+	jerry_value_free(prefixv);
+
+	jerry_value_t familyv = jerry_number(subnet->family == ISR_SUBNET_IPV6 ? 6 : 4);
+	jerry_value_free(jerry_object_set_sz(ret, "family", familyv));
+	jerry_value_free(familyv);
+
+	jerry_value_t ecsv = jerry_boolean(subnet->ecs);
+	jerry_value_free(jerry_object_set_sz(ret, "ecs", ecsv));
+	jerry_value_free(ecsv);
+
+	return ret;
+}
+
+/* Address and port the query was sent from, which may be a forwarder's */
+jerry_value_t isr_script_question_get_address(struct question *question) {
+	if (question->source == NULL) return jerry_undefined();
+	return isr_script_address(&question->source->peer.sin_addr);
+}
+
+jerry_value_t isr_script_question_get_port(struct question *question) {
+	if (question->source == NULL) return jerry_undefined();
+	return jerry_number(ntohs(question->source->peer.sin_port));
+}
+
+/*
+	{ address: "192.168.0.1", port: 53, interface: "eth0" }, where the query came in.
+*/
+jerry_value_t isr_script_question_get_listener(struct question *question) {
+	if (question->source == NULL) return jerry_undefined();
+
+	jerry_value_t ret = jerry_object();
+
+	jerry_value_t addressv = isr_script_address(&question->source->listener.sin_addr);
+	jerry_value_free(jerry_object_set_sz(ret, "address", addressv));
+	jerry_value_free(addressv);
+
+	jerry_value_t portv = jerry_number(ntohs(question->source->listener.sin_port));
+	jerry_value_free(jerry_object_set_sz(ret, "port", portv));
+	jerry_value_free(portv);
+
+	char interface[IF_NAMESIZE];
+	if (question->source->interface != 0 && if_indextoname(question->source->interface, interface) != NULL) {
+		jerry_value_t interfacev = jerry_string_sz(interface);
+		jerry_value_free(jerry_object_set_sz(ret, "interface", interfacev));
+		jerry_value_free(interfacev);
+	}
+
+	return ret;
+}
+
+jerry_value_t isr_script_question_get_transport(struct question *question) {
+	if (question->source == NULL) return jerry_undefined();
+	return jerry_string_sz(question->source->transport);
+}
+
+jerry_value_t isr_script_question_get_id(struct question *question) {
+	if (question->view == NULL) return jerry_undefined();
+	return jerry_number(question->view->header.id);
+}
+
+jerry_value_t isr_script_question_get_recursionDesired(struct question *question) {
+	if (question->view == NULL) return jerry_undefined();
+	return jerry_boolean(question->view->header.rd);
+}
+
+/*
+	{ udpSize: 1232, version: 0, dnssecOk: false }, undefined if the query had no OPT.
+*/
+jerry_value_t isr_script_question_get_edns(struct question *question) {
+	if (question->view == NULL || !question->view->edns) return jerry_undefined();
+
+	jerry_value_t ret = jerry_object();
+
+	jerry_value_t udp_sizev = jerry_number(question->view->udp_size);
+	jerry_value_free(jerry_object_set_sz(ret, "udpSize", udp_sizev));
+	jerry_value_free(udp_sizev);
+
+	jerry_value_t versionv = jerry_number(question->view->edns_version);
+	jerry_value_free(jerry_object_set_sz(ret, "version", versionv));
+	jerry_value_free(versionv);
+
+	jerry_value_t dnssec_okv = jerry_boolean(question->view->dnssec_ok);
+	jerry_value_free(jerry_object_set_sz(ret, "dnssecOk", dnssec_okv));
+	jerry_value_free(dnssec_okv);
+
+	return ret;
+}
+
+ISR_QUESTION_GETTER(client)
+ISR_QUESTION_GETTER(address)
+ISR_QUESTION_GETTER(port)
+ISR_QUESTION_GETTER(listener)
+ISR_QUESTION_GETTER(transport)
+ISR_QUESTION_GETTER(id)
+ISR_QUESTION_GETTER(recursionDesired)
+ISR_QUESTION_GETTER(edns)
+
+const char *isr_script_question_getters[] = { "client", "address", "port", "listener", "transport", "id", "recursionDesired", "edns" };
+
+jerry_value_t isr_script_question_prototype() {
+	const char **names = isr_script_question_getters;
+	jerry_external_handler_t getters[] = {
+		&isr_script_question_client,
+		&isr_script_question_address,
+		&isr_script_question_port,
+		&isr_script_question_listener,
+		&isr_script_question_transport,
+		&isr_script_question_id,
+		&isr_script_question_recursionDesired,
+		&isr_script_question_edns,
+	};
+
+	jerry_value_t ret = jerry_object();
+
+	for (size_t i = 0; i < sizeof(getters) / sizeof(getters[0]); i++) {
+		jerry_property_descriptor_t desc = jerry_property_descriptor();
+		desc.flags = JERRY_PROP_IS_GET_DEFINED | JERRY_PROP_IS_CONFIGURABLE_DEFINED | JERRY_PROP_IS_CONFIGURABLE;
+		desc.getter = jerry_function_external(getters[i]);
+
+		jerry_value_t namev = jerry_string_sz(names[i]);
+		jerry_value_free(jerry_object_define_own_prop(ret, namev, &desc));
+		jerry_value_free(namev);
+
+		jerry_property_descriptor_free(&desc);
+	}
+
+	return ret;
+}
+
+jerry_value_t isr_script_object_question(struct script_bindings *bindings, struct question *question) {
+	jerry_value_t ret = jerry_object();
+
+	jerry_value_free(jerry_object_set_proto(ret, bindings->question_proto));
+	jerry_object_set_native_ptr(ret, &isr_script_question_info, question);
+
 	jerry_value_t namev = jerry_string_sz(question->qname);
-	jerry_value_t namer = jerry_object_set_sz(ret, "name", namev);
+	jerry_value_t namer = jerry_object_set(ret, bindings->strings[ISR_STRING_NAME], namev);
 	jerry_value_free(namev);
 	if (jerry_value_is_exception(namer)) return namer;
 
 	jerry_value_t typev = jerry_number(question->qtype);
-	jerry_value_t typer = jerry_object_set_sz(ret, "type", typev);
+	jerry_value_t typer = jerry_object_set(ret, bindings->strings[ISR_STRING_TYPE], typev);
 	jerry_value_free(typev);
 	if (jerry_value_is_exception(typer)) { ret = typer; goto free_pre_typer; }
 
 	jerry_value_t classv = jerry_number(question->qclass);
-	jerry_value_t classr = jerry_object_set_sz(ret, "class", classv);
+	jerry_value_t classr = jerry_object_set(ret, bindings->strings[ISR_STRING_CLASS], classv);
 	jerry_value_free(classv);
 	if (jerry_value_is_exception(classr)) { ret = classr; goto free_pre_classr; }
 
@@ -73,160 +405,494 @@ free_pre_typer:
 	return ret;
 }
 
-jerry_value_t isr_script_call(jerry_value_t module, struct question *question, struct state_provider **providers, size_t providers_size) {
-	jerry_value_t ret;
+/*
+	Each resolve() runs against a deadline of script_budget ms, which the halt handler
+	checks every ISR_SCRIPT_HALT_INTERVAL backward jumps and calls. Running past it
+	aborts the call, which no try/catch in the script can stop.
+	The handler is only ever called by a jerry-core built with JERRY_VM_HALT=1, which
+	the vendored jerryscript-config.h leaves off; with any other the budget does nothing.
+	Counters belong to the script last bound and start over with each one.
+*/
 
-	jerry_value_t namespace = jerry_module_namespace(module);
-	if (jerry_value_is_exception(namespace)) return namespace;
-	
-	jerry_value_t resolve = jerry_object_get_sz(namespace, "resolve");
-	jerry_value_free(namespace);
-	if (jerry_value_is_exception(resolve)) return resolve;
-	
-	jerry_value_t questiono = isr_script_object_question(question);
-	if (jerry_value_is_exception(questiono)) { ret = questiono; goto free_pre_questiono; }
+uint64_t isr_script_deadline = UINT64_MAX;
+struct script_stats isr_script_totals;
+char isr_script_halted[256]; /* source name of the script the last abort stopped */
 
-	jerry_value_t stateo = isr_script_object_state(providers, providers_size);
-	if (jerry_value_is_exception(stateo)) { ret = stateo; goto free_pre_stateo; }
+/*
+	Takes the source name of the innermost function on the stack, which every module
+	gets from its resolver.
+*/
+bool isr_script_halt_frame(jerry_frame_t *frame_p, void *user_p) {
+	const jerry_value_t *callee = jerry_frame_callee(frame_p);
+	if (callee == NULL) return true;
+
+	jerry_value_t name = jerry_source_name(*callee);
+	if (jerry_value_is_string(name)) {
+		jerry_size_t size = jerry_string_to_buffer(name, JERRY_ENCODING_UTF8, (jerry_char_t *) isr_script_halted, sizeof(isr_script_halted) - 1);
+		isr_script_halted[size] = '\0';
+	}
+	jerry_value_free(name);
+
+	return false;
+}
+
+jerry_value_t isr_script_halt(void *user_p) {
+	if (isr_clock_ms() < isr_script_deadline) return jerry_undefined();
+
+	strcpy(isr_script_halted, "unknown");
+	jerry_backtrace_capture(&isr_script_halt_frame, NULL);
+
+	return jerry_throw_abort(jerry_string_sz("resolve() ran past its budget"), true);
+}
+
+/*
+	Counts an abort, against the script isr_script_halt found running.
+*/
+void isr_script_overran() {
+	isr_script_totals.budget_exceeded++;
+
+	struct script_overrun **link = &isr_script_totals.overruns;
+	while (*link != NULL && strcmp((*link)->script, isr_script_halted) != 0) link = &(*link)->next;
+
+	if (*link == NULL) {
+		*link = malloc(sizeof(struct script_overrun) + strlen(isr_script_halted) + 1);
+		(*link)->next = NULL;
+		(*link)->count = 0;
+		strcpy((*link)->script, isr_script_halted);
+	}
+
+	(*link)->count++;
+}
+
+void isr_script_stats(struct script_stats *stats) {
+	*stats = isr_script_totals;
+}
+
+/*
+	Calls fn under the script budget, which a call deciding count questions gets count times of.
+*/
+jerry_value_t isr_script_invoke(jerry_value_t fn, const jerry_value_t *args, jerry_size_t argscnt, size_t count) {
+	uint64_t start = isr_clock_ms();
+	if (isr_config.script_budget > 0) isr_script_deadline = start + (uint64_t) isr_config.script_budget * count;
+
+	jerry_value_t ret = jerry_call(fn, jerry_undefined(), args, argscnt);
+
+	isr_script_deadline = UINT64_MAX;
+
+	uint64_t elapsed = isr_clock_ms() - start;
+	isr_script_totals.calls++;
+	if (elapsed > isr_script_totals.slowest) isr_script_totals.slowest = elapsed;
+	if (jerry_value_is_abort(ret)) isr_script_overran();
+
+	return ret;
+}
+
+bool isr_script_is_pending(jerry_value_t value) {
+	return jerry_value_is_promise(value) && jerry_promise_state(value) == JERRY_PROMISE_STATE_PENDING;
+}
+
+/*
+	Cuts questiono off the question it was made from once the call is over.
+	The question may outlive the call in the script, but not its getters, so a call
+	that left something pending gets their values up front.
+*/
+void isr_script_question_release(jerry_value_t questiono, bool pending) {
+	if (pending) {
+		for (size_t i = 0; i < sizeof(isr_script_question_getters) / sizeof(isr_script_question_getters[0]); i++) {
+			jerry_value_free(jerry_object_get_sz(questiono, isr_script_question_getters[i]));
+		}
+	}
+
+	jerry_object_delete_native_ptr(questiono, &isr_script_question_info);
+}
+
+jerry_value_t isr_script_call(struct script_bindings *bindings, struct question *question, jerry_value_t stateo) {
+	jerry_value_t questiono = isr_script_object_question(bindings, question);
+	if (jerry_value_is_exception(questiono)) return questiono;
 
 	jerry_value_t args[] = { questiono, stateo };
 	jerry_size_t argscnt = 2;
 
-	ret = jerry_call(resolve, jerry_undefined(), args, argscnt);
+	jerry_value_t ret = isr_script_invoke(bindings->resolve, args, argscnt, 1);
 
-	jerry_value_free(stateo);
-free_pre_stateo:
+	isr_script_question_release(questiono, isr_script_is_pending(ret));
 	jerry_value_free(questiono);
-free_pre_questiono:
-	jerry_value_free(resolve);
 
 	return ret;
 }
 
-jerry_value_t isr_script_result_constructors(jerry_value_t *answerc, jerry_value_t *forwardc) {
+/*
+	Calls resolveBatch() with the questions at indexes, expecting an array holding
+	what resolve() would have returned for each of them, in the same order.
+*/
+jerry_value_t isr_script_call_batch(struct script_bindings *bindings, struct question **questions, size_t *indexes, size_t length, jerry_value_t stateo) {
 	jerry_value_t ret;
 
+	jerry_value_t questionsa = jerry_array(length);
+	jerry_value_t *questionso = malloc(length * sizeof(jerry_value_t));
+	size_t made = 0;
+	bool pending = false;
+
+	for (; made < length; made++) {
+		questionso[made] = isr_script_object_question(bindings, questions[indexes[made]]);
+		if (jerry_value_is_exception(questionso[made])) { ret = questionso[made]; goto free_questions; }
+
+		jerry_value_free(jerry_object_set_index(questionsa, made, questionso[made]));
+	}
+
+	jerry_value_t args[] = { questionsa, stateo };
+	jerry_size_t argscnt = 2;
+
+	ret = isr_script_invoke(bindings->resolve_batch, args, argscnt, length);
+
+	if (!jerry_value_is_exception(ret) && !(jerry_value_is_array(ret) && jerry_array_length(ret) == length)) {
+		jerry_value_free(ret);
+		ret = jerry_throw_value(jerry_string_sz("Expected resolveBatch to return an array with a result for each question"), true);
+	}
+
+	for (size_t i = 0; !jerry_value_is_exception(ret) && i < length && !pending; i++) {
+		jerry_value_t element = jerry_object_get_index(ret, i);
+		pending = isr_script_is_pending(element);
+		jerry_value_free(element);
+	}
+
+free_questions:
+	for (size_t i = 0; i < made; i++) {
+		isr_script_question_release(questionso[i], pending);
+		jerry_value_free(questionso[i]);
+	}
+
+	free(questionso);
+	jerry_value_free(questionsa);
+
+	return ret;
+}
+
+const char *isr_script_strings[ISR_STRINGS] = {
+	[ISR_STRING_NAME] = "name",
+	[ISR_STRING_TYPE] = "type",
+	[ISR_STRING_CLASS] = "class",
+	[ISR_STRING_RDATA] = "rdata",
+	[ISR_STRING_IP] = "ip",
+	[ISR_STRING_TTL] = "ttl",
+	[ISR_STRING_RCODE] = "rcode",
+	[ISR_STRING_RECORDS] = "records",
+	[ISR_STRING_AUTHORITY] = "authority",
+	[ISR_STRING_ADDITIONAL] = "additional",
+	[ISR_STRING_CACHE] = "cache",
+	[ISR_STRING_SCOPE] = "scope",
+	[ISR_STRING_DEPENDS] = "depends",
+	[ISR_STRING_TOUINT8ARRAY] = "toUint8Array",
+};
+
+/*
+	Looks up resolve() and resolveBatch() of module and Answer and Forward of result.js, taking over module.
+	Reports what went wrong and returns NULL if any of them is missing.
+*/
+struct script_bindings *isr_script_bind(jerry_value_t module) {
+	struct script_bindings *ret = NULL;
+
+	jerry_value_t namespace = jerry_module_namespace(module);
+	if (jerry_value_is_exception(namespace)) { isr_script_report(namespace); goto free_module; }
+
+	jerry_value_t resolve = jerry_object_get_sz(namespace, "resolve");
+	jerry_value_t resolve_batch = jerry_object_get_sz(namespace, "resolveBatch");
+	jerry_value_free(namespace);
+	if (!jerry_value_is_function(resolve)) {
+		jerry_value_free(resolve);
+		jerry_value_free(resolve_batch);
+		isr_script_report(jerry_throw_value(jerry_string_sz("resolve is not an exported function"), true));
+		goto free_module;
+	}
+
+	/* resolveBatch() is optional, isr falling back to resolve() for each question */
+	if (!jerry_value_is_function(resolve_batch)) {
+		jerry_value_free(resolve_batch);
+		resolve_batch = jerry_undefined();
+	}
+
 	jerry_value_t result_module = isr_module_result();
-	if (jerry_value_is_exception(result_module)) return result_module;
+	if (jerry_value_is_exception(result_module)) { isr_script_report(result_module); goto free_resolve; }
 
-	jerry_value_t namespace = jerry_module_namespace(result_module);
+	jerry_value_t result_namespace = jerry_module_namespace(result_module);
 	jerry_value_free(result_module);
-	
-	jerry_value_t answer = jerry_object_get_sz(namespace, "Answer");
-	if (jerry_value_is_exception(answer)) { ret = answer; goto free_namespace; }
-	*answerc = answer;
+	if (jerry_value_is_exception(result_namespace)) { isr_script_report(result_namespace); goto free_resolve; }
+
+	jerry_value_t answer = jerry_object_get_sz(result_namespace, "Answer");
+	jerry_value_t forward = jerry_object_get_sz(result_namespace, "Forward");
+	jerry_value_free(result_namespace);
+	if (!jerry_value_is_function(answer) || !jerry_value_is_function(forward)) {
+		isr_script_report(jerry_throw_value(jerry_string_sz("result.js doesn't export Answer and Forward"), true));
+		goto free_constructors;
+	}
 
-	jerry_value_t forward = jerry_object_get_sz(namespace, "Forward");
-	if (jerry_value_is_exception(forward)) { ret = forward; jerry_value_free(answer); goto free_namespace; }
-	*forwardc = forward;
+	ret = malloc(sizeof(struct script_bindings));
+	ret->module = module;
+	ret->resolve = resolve;
+	ret->resolve_batch = resolve_batch;
+	ret->answer = answer;
+	ret->forward = forward;
+	ret->question_proto = isr_script_question_prototype();
 
-	ret = jerry_boolean(true);
+	for (size_t i = 0; i < ISR_STRINGS; i++) {
+		ret->strings[i] = jerry_string_sz(isr_script_strings[i]);
+	}
 
-free_namespace:
-	jerry_value_free(namespace);
+	while (isr_script_totals.overruns != NULL) {
+		struct script_overrun *next = isr_script_totals.overruns->next;
+		free(isr_script_totals.overruns);
+		isr_script_totals.overruns = next;
+	}
+	memset(&isr_script_totals, 0, sizeof(isr_script_totals));
+	if (isr_config.script_budget > 0) {
+		/* The halt handler is only ever called by a jerry-core built with JERRY_VM_HALT */
+		if (jerry_feature_enabled(JERRY_FEATURE_VM_EXEC_STOP)) jerry_halt_handler(ISR_SCRIPT_HALT_INTERVAL, &isr_script_halt, NULL);
+		else printf("isr: jerry-core is built without JERRY_VM_HALT, script_budget is not enforced\n");
+	}
+
+	return ret;
+
+free_constructors:
+	jerry_value_free(answer);
+	jerry_value_free(forward);
+free_resolve:
+	jerry_value_free(resolve_batch);
+	jerry_value_free(resolve);
+free_module:
+	jerry_value_free(module);
 
 	return ret;
 }
 
+void isr_script_unbind(struct script_bindings *bindings) {
+	for (size_t i = 0; i < ISR_STRINGS; i++) {
+		jerry_value_free(bindings->strings[i]);
+	}
+
+	jerry_value_free(bindings->question_proto);
+	jerry_value_free(bindings->forward);
+	jerry_value_free(bindings->answer);
+	jerry_value_free(bindings->resolve_batch);
+	jerry_value_free(bindings->resolve);
+	jerry_value_free(bindings->module);
+
+	free(bindings);
+}
+
 /*
  * This function will jerry_value_free the given exception.
  */
-struct resolve_result *isr_result_fallback(jerry_value_t exception) {
+void isr_script_report(jerry_value_t exception) {
 	jerry_value_t exception_val = jerry_exception_value(exception, true); /* This will jerry_value_free exception instead */
 	jerry_value_t str = jerry_value_to_string(exception_val);
 	jerry_value_free(exception_val);
 
-	jerry_size_t str_size = jerry_string_size(str, JERRY_ENCODING_UTF8);
-
-	jerry_char_t *buff = malloc(str_size * sizeof(jerry_char_t));
-	jerry_size_t buff_size = jerry_string_to_buffer(str, JERRY_ENCODING_UTF8, buff, jerry_string_size(str, JERRY_ENCODING_UTF8));
-	buff[buff_size] = '\0';
+	char *buff = isr_from_jerry_string(str);
 	jerry_value_free(str);
 
 	printf("isr: isr.js: %s\n", buff);
 	free(buff);
+}
+
+/*
+ * This function will jerry_value_free the given exception.
+ */
+struct resolve_result *isr_result_fallback(jerry_value_t exception) {
+	isr_script_report(exception);
 
+	return isr_result_failed();
+}
+
+/*
+	A FALLBACK result for a failure already reported.
+*/
+struct resolve_result *isr_result_failed() {
 	struct resolve_result *ret = malloc(sizeof(struct resolve_result));
 	ret->type = FALLBACK;
+	ret->hint = NULL;
 	return ret;
 }
 
-struct resolve_result *isr_from_call_result(jerry_value_t call_result, jerry_value_t answerc, jerry_value_t forwardc) {
+/*
+	Returns rdata itself if it already is a TypedArray, else what its toUint8Array() returns.
+*/
+jerry_value_t isr_from_jerry_rdata(struct script_bindings *bindings, jerry_value_t rdata) {
+	if (jerry_value_is_typedarray(rdata)) return jerry_value_copy(rdata);
+	if (!jerry_value_is_object(rdata)) return jerry_throw_value(jerry_string_sz("rdata is not an object"), true);
+
+	jerry_value_t ret;
+
+	jerry_value_t touint8array = jerry_object_get(rdata, bindings->strings[ISR_STRING_TOUINT8ARRAY]);
+	if (jerry_value_is_exception(touint8array)) return touint8array;
+	if (!jerry_value_is_function(touint8array)) {
+		ret = jerry_throw_value(jerry_string_sz("toUint8Array is not a function"), true);
+		goto free_touint8array;
+	}
+
+	ret = jerry_call(touint8array, rdata, NULL, 0);
+	if (!jerry_value_is_exception(ret) && !jerry_value_is_typedarray(ret)) {
+		jerry_value_free(ret);
+		ret = jerry_throw_value(jerry_string_sz("toUint8Array didn't return TypedArray"), true);
+	}
+
+free_touint8array:
+	jerry_value_free(touint8array);
+
+	return ret;
+}
+
+/*
+	Reads { type, rdata, ttl, name } into record, ttl and name being optional.
+	record->rdata is left pointing into the ArrayBuffer behind rdata, which record
+	keeps alive, so the octets are never copied before they are written out.
+	Returns an exception if record isn't usable.
+*/
+jerry_value_t isr_from_jerry_record(struct script_bindings *bindings, jerry_value_t record, struct resolve_result_record *ret) {
+	jerry_value_t result;
+
+	jerry_value_t type = jerry_object_get(record, bindings->strings[ISR_STRING_TYPE]);
+	if (jerry_value_is_exception(type)) return type;
+	if (!jerry_value_is_number(type)) {
+		result = jerry_throw_value(jerry_string_sz("type is not a number"), true);
+		goto free_type;
+	}
+
+	jerry_value_t rdata = jerry_object_get(record, bindings->strings[ISR_STRING_RDATA]);
+	if (jerry_value_is_exception(rdata)) { result = rdata; goto free_pre_rdata; }
+
+	jerry_value_t typedarray = isr_from_jerry_rdata(bindings, rdata);
+	if (jerry_value_is_exception(typedarray)) { result = typedarray; goto free_pre_typedarray; }
+
+	jerry_length_t offset, length;
+	jerry_value_t buffer = jerry_typedarray_buffer(typedarray, &offset, &length);
+	if (jerry_value_is_exception(buffer)) { result = buffer; goto free_pre_buffer; }
+	if (length > UINT16_MAX) {
+		result = jerry_throw_value(jerry_string_sz("rdata is longer than 65535 octets"), true);
+		goto free_buffer;
+	}
+
+	uint8_t *data = jerry_arraybuffer_data(buffer);
+	if (data == NULL && length > 0) {
+		result = jerry_throw_value(jerry_string_sz("rdata is detached"), true);
+		goto free_buffer;
+	}
+
+	ret->type = jerry_value_as_uint32(type);
+	ret->rdata = data != NULL ? data + offset : NULL;
+	ret->rdlength = length;
+	ret->backing = buffer;
+	buffer = jerry_undefined();
+
+	jerry_value_t ttl = jerry_object_get(record, bindings->strings[ISR_STRING_TTL]);
+	ret->has_ttl = jerry_value_is_number(ttl);
+	ret->ttl = ret->has_ttl ? jerry_value_as_uint32(ttl) : 0;
+	jerry_value_free(ttl);
+
+	jerry_value_t name = jerry_object_get(record, bindings->strings[ISR_STRING_NAME]);
+	ret->name = jerry_value_is_string(name) ? isr_from_jerry_string(name) : NULL;
+	jerry_value_free(name);
+
+	result = jerry_boolean(true);
+
+free_buffer:
+	jerry_value_free(buffer);
+free_pre_buffer:
+	jerry_value_free(typedarray);
+free_pre_typedarray:
+	jerry_value_free(rdata);
+free_type:
+free_pre_rdata:
+	jerry_value_free(type);
+
+	return result;
+}
+
+/*
+	Reads an array of records into *ret, undefined meaning none.
+	Returns an exception if any of them isn't usable, *ret then holding the ones read before it.
+*/
+jerry_value_t isr_from_jerry_records(struct script_bindings *bindings, jerry_value_t records, struct resolve_result_record **ret, size_t *length) {
+	*ret = NULL;
+	*length = 0;
+
+	if (jerry_value_is_undefined(records)) return jerry_boolean(true);
+	if (!jerry_value_is_array(records)) return jerry_throw_value(jerry_string_sz("records is not an array"), true);
+
+	uint32_t records_length = jerry_array_length(records);
+	*ret = malloc((records_length + 1) * sizeof(struct resolve_result_record));
+
+	for (uint32_t i = 0; i < records_length; i++) {
+		jerry_value_t record = jerry_object_get_index(records, i);
+		jerry_value_t recordr = isr_from_jerry_record(bindings, record, &(*ret)[i]);
+		jerry_value_free(record);
+
+		if (jerry_value_is_exception(recordr)) return recordr;
+
+		jerry_value_free(recordr);
+		(*length)++;
+	}
+
+	return jerry_boolean(true);
+}
+
+struct resolve_result *isr_from_call_result(struct script_bindings *bindings, jerry_value_t call_result) {
 	if (jerry_value_is_exception(call_result)) return isr_result_fallback(jerry_undefined());
 
-	jerry_value_t is_answer_jerry = jerry_binary_op(JERRY_BIN_OP_INSTANCEOF, call_result, answerc);
+	jerry_value_t is_answer_jerry = jerry_binary_op(JERRY_BIN_OP_INSTANCEOF, call_result, bindings->answer);
 	if (jerry_value_is_exception(is_answer_jerry)) return isr_result_fallback(is_answer_jerry);
 	bool is_answer = jerry_value_to_boolean(is_answer_jerry);
 	jerry_value_free(is_answer_jerry);
 
-	jerry_value_t is_forward_jerry = jerry_binary_op(JERRY_BIN_OP_INSTANCEOF, call_result, forwardc);
+	jerry_value_t is_forward_jerry = jerry_binary_op(JERRY_BIN_OP_INSTANCEOF, call_result, bindings->forward);
 	if (jerry_value_is_exception(is_forward_jerry)) return isr_result_fallback(is_forward_jerry);
 	bool is_forward = jerry_value_to_boolean(is_forward_jerry);
 	jerry_value_free(is_forward_jerry);
 
 	if (is_answer) {
-		struct resolve_result *ret;
-
-		jerry_value_t type = jerry_object_get_sz(call_result, "type");
-		if (jerry_value_is_exception(type)) return isr_result_fallback(type);
-		if (!jerry_value_is_number(type)) {
-			jerry_value_t exception = jerry_throw_value(jerry_string_sz("type is not a number"), true);
-			ret = isr_result_fallback(exception);
-			goto free_type;
-		}
-
-		jerry_value_t rdata = jerry_object_get_sz(call_result, "rdata");
-		if (jerry_value_is_exception(rdata)) { ret = isr_result_fallback(rdata); goto free_pre_rdata; }
-		if (!jerry_value_is_object(rdata)) {
-			jerry_value_t exception = jerry_throw_value(jerry_string_sz("rdata is not an object"), true);
-			ret = isr_result_fallback(exception);
-			goto free_rdata;
-		}
-
-		jerry_value_t touint8array = jerry_object_get_sz(rdata, "toUint8Array");
-		if (jerry_value_is_exception(touint8array)) { ret = isr_result_fallback(touint8array); goto free_pre_touint8array; }
-		if (!jerry_value_is_function(touint8array)) {
-			jerry_value_t exception = jerry_throw_value(jerry_string_sz("toUint8Array is not a function"), true);
-			ret = isr_result_fallback(exception);
-			goto free_touint8array;
-		}
-
-		jerry_value_t typedarray = jerry_call(touint8array, rdata, NULL, 0);
-		if (jerry_value_is_exception(typedarray)) { ret = isr_result_fallback(typedarray); goto free_pre_typedarray; }
-		if (!jerry_value_is_typedarray(typedarray)) {
-			jerry_value_t exception = jerry_throw_value(jerry_string_sz("toUint8Array didn't return TypedArray"), true);
-			ret =  isr_result_fallback(exception);
-			goto free_typedarray;
+		struct resolve_result_answer *ans = calloc(1, sizeof(struct resolve_result_answer));
+
+		jerry_value_t rcode = jerry_object_get(call_result, bindings->strings[ISR_STRING_RCODE]);
+		ans->rcode = jerry_value_is_number(rcode) ? jerry_value_as_uint32(rcode) & 0x0F : 0;
+		jerry_value_free(rcode);
+
+		jerry_value_t records = jerry_object_get(call_result, bindings->strings[ISR_STRING_RECORDS]);
+		jerry_value_t recordsr;
+		if (jerry_value_is_array(records)) {
+			recordsr = isr_from_jerry_records(bindings, records, &ans->records, &ans->records_length);
+		} else {
+			/* An Answer either carries records or is a single record itself */
+			ans->records = malloc(sizeof(struct resolve_result_record));
+			recordsr = isr_from_jerry_record(bindings, call_result, ans->records);
+			ans->records_length = jerry_value_is_exception(recordsr) ? 0 : 1;
 		}
+		jerry_value_free(records);
+		if (jerry_value_is_exception(recordsr)) goto free_answer;
+		jerry_value_free(recordsr);
+
+		jerry_value_t authority = jerry_object_get(call_result, bindings->strings[ISR_STRING_AUTHORITY]);
+		recordsr = isr_from_jerry_records(bindings, authority, &ans->authority, &ans->authority_length);
+		jerry_value_free(authority);
+		if (jerry_value_is_exception(recordsr)) goto free_answer;
+		jerry_value_free(recordsr);
+
+		jerry_value_t additional = jerry_object_get(call_result, bindings->strings[ISR_STRING_ADDITIONAL]);
+		recordsr = isr_from_jerry_records(bindings, additional, &ans->additional, &ans->additional_length);
+		jerry_value_free(additional);
+		if (jerry_value_is_exception(recordsr)) goto free_answer;
+		jerry_value_free(recordsr);
 
-		uint16_t rdlength;
-		unsigned char* rdatav = isr_from_jerry_typedarray(typedarray, &rdlength);
-
-		ret = malloc(sizeof(struct resolve_result));
+		struct resolve_result *ret = malloc(sizeof(struct resolve_result));
 		ret->type = ANSWER;
-
-		struct resolve_result_answer *ans = malloc(sizeof(struct resolve_result_answer));
-		ans->type = jerry_value_as_uint32(type);
-		ans->rdlength = rdlength;
-		ans->rdata = rdatav;
-
+		ret->hint = isr_from_jerry_hint(bindings, call_result);
 		ret->value.answer = ans;
 
-free_typedarray:
-		jerry_value_free(typedarray);
-free_touint8array:
-free_pre_typedarray:
-		jerry_value_free(touint8array);
-free_rdata:
-free_pre_touint8array:
-		jerry_value_free(rdata);
-free_type:
-free_pre_rdata:
-		jerry_value_free(type);
-
 		return ret;
+
+free_answer:
+		isr_resolve_result_answer_free(ans);
+		return isr_result_fallback(recordsr);
 	} else if (is_forward) {
-		jerry_value_t ip = jerry_object_get_sz(call_result, "ip");
+		jerry_value_t ip = jerry_object_get(call_result, bindings->strings[ISR_STRING_IP]);
 		if (jerry_value_is_exception(ip)) return isr_result_fallback(ip);
 
 		char *buff = malloc(16 * sizeof(char));
@@ -236,6 +902,7 @@ free_pre_rdata:
 
 		struct resolve_result *ret = malloc(sizeof(struct resolve_result));
 		ret->type = FORWARD;
+		ret->hint = isr_from_jerry_hint(bindings, call_result);
 
 		struct resolve_result_forward *fwd = malloc(sizeof(struct resolve_result_forward));
  		fwd->ip = buff;
@@ -251,23 +918,167 @@ free_pre_rdata:
 	}
 }
 
-struct resolve_result *isr_script_run(jerry_value_t module, struct question *question, struct state_provider **providers, size_t providers_size) {
+/*
+	Turns what resolve() returned, or what the promise it returned settled with, into a result,
+	taking over value. A promise still pending comes back as a PENDING result holding it.
+	The decision is cached only if store is set.
+*/
+struct resolve_result *isr_script_result(struct script_bindings *bindings, struct question *question, jerry_value_t value, struct state_provider **providers, size_t providers_size, bool store) {
 	struct resolve_result *ret;
 
-	jerry_value_t callr = isr_script_call(module, question, providers, providers_size);
-	if (jerry_value_is_exception(callr)) return isr_result_fallback(callr);
+	if (jerry_value_is_exception(value)) return isr_result_fallback(value);
 
-	jerry_value_t answerc, forwardc;
-	jerry_value_t constructorsr = isr_script_result_constructors(&answerc, &forwardc);
-	if (jerry_value_is_exception(constructorsr)) { ret = isr_result_fallback(constructorsr); goto free_pre_constructorsr; }
+	if (jerry_value_is_promise(value)) {
+		jerry_promise_state_t state = jerry_promise_state(value);
 
-	ret = isr_from_call_result(callr, answerc, forwardc);
+		if (state == JERRY_PROMISE_STATE_PENDING) {
+			ret = malloc(sizeof(struct resolve_result));
+			ret->type = PENDING;
+			ret->hint = NULL;
+			ret->value.promise = value;
+			return ret;
+		}
+
+		jerry_value_t settled = jerry_promise_result(value);
+		jerry_value_free(value);
 
-	jerry_value_free(answerc);
-	jerry_value_free(forwardc);
-	jerry_value_free(constructorsr);
-free_pre_constructorsr:
-	jerry_value_free(callr);
+		if (state == JERRY_PROMISE_STATE_REJECTED) return isr_result_fallback(jerry_throw_value(settled, true));
+		value = settled;
+	}
+
+	ret = isr_from_call_result(bindings, value);
+	jerry_value_free(value);
+
+	if (store && ret->hint != NULL) isr_decision_store(question, ret, providers, providers_size);
+
+	return ret;
+}
+
+/*
+	Decides count questions, results[i] being the result for questions[i].
+	Decisions cached for any of them are reused, and the rest are decided with one
+	state object between them: by a single resolveBatch() if isr.js exports it,
+	else by resolve() for each question.
+*/
+void isr_script_run_batch(struct script_bindings *bindings, struct question **questions, size_t count, struct state_provider **providers, size_t providers_size, struct resolve_result **results) {
+	isr_script_state_refresh(providers, providers_size);
+
+	size_t *undecided = malloc(count * sizeof(size_t));
+	size_t undecided_length = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		results[i] = isr_decision_lookup(questions[i]);
+		if (results[i] == NULL) undecided[undecided_length++] = i;
+	}
+
+	if (undecided_length == 0) goto free_undecided;
+
+	jerry_value_t stateo = isr_script_object_state(providers, providers_size);
+	if (jerry_value_is_exception(stateo)) {
+		results[undecided[0]] = isr_result_fallback(stateo);
+		for (size_t i = 1; i < undecided_length; i++) results[undecided[i]] = isr_result_failed();
+		goto free_undecided;
+	}
+
+	if (!jerry_value_is_undefined(bindings->resolve_batch) && undecided_length > 1) {
+		jerry_value_t batchr = isr_script_call_batch(bindings, questions, undecided, undecided_length, stateo);
+
+		if (jerry_value_is_exception(batchr)) {
+			results[undecided[0]] = isr_result_fallback(batchr);
+			for (size_t i = 1; i < undecided_length; i++) results[undecided[i]] = isr_result_failed();
+		} else {
+			for (size_t i = 0; i < undecided_length; i++) {
+				struct question *question = questions[undecided[i]];
+				results[undecided[i]] = isr_script_result(bindings, question, jerry_object_get_index(batchr, i), providers, providers_size, true);
+			}
+			jerry_value_free(batchr);
+		}
+	} else {
+		for (size_t i = 0; i < undecided_length; i++) {
+			struct question *question = questions[undecided[i]];
+			results[undecided[i]] = isr_script_result(bindings, question, isr_script_call(bindings, question, stateo), providers, providers_size, true);
+		}
+	}
+
+	jerry_value_free(stateo);
+free_undecided:
+	free(undecided);
+}
+
+/*
+	Runs the jobs promises have queued, which is what moves an async resolve() on past
+	each await, under the budget of count calls to resolve(), count being the queries
+	waiting on them. JerryScript only runs the whole queue at once, so the budget is
+	shared: whichever job is running when it runs out is aborted, slow or not, and
+	only the jobs queued behind it are left for the next run.
+*/
+void isr_script_jobs(size_t count) {
+	if (count == 0) count = 1;
+	if (isr_config.script_budget > 0) isr_script_deadline = isr_clock_ms() + (uint64_t) isr_config.script_budget * count;
+
+	jerry_value_t jobsr = jerry_run_jobs();
+
+	isr_script_deadline = UINT64_MAX;
+
+	if (jerry_value_is_exception(jobsr)) {
+		if (jerry_value_is_abort(jobsr)) isr_script_overran();
+		isr_script_report(jobsr);
+		return;
+	}
+
+	jerry_value_free(jobsr);
+}
+
+/*
+	Reads the answers isr.js declares static, e.g.
+	export const staticAnswers = { "router.lan": new Answer(Type.A, new IPV4("192.168.0.1")) };
+	A name may also map to an array of Answers, one per type.
+	Anything that isn't an Answer is reported and left out.
+*/
+struct static_answer *isr_script_static_answers(struct script_bindings *bindings, size_t *size) {
+	struct static_answer *ret = NULL;
+	*size = 0;
+
+	jerry_value_t namespace = jerry_module_namespace(bindings->module);
+	if (jerry_value_is_exception(namespace)) { jerry_value_free(namespace); return NULL; }
+
+	jerry_value_t answers = jerry_object_get_sz(namespace, "staticAnswers");
+	if (!jerry_value_is_object(answers)) goto free_answers;
+
+	jerry_value_t keys = jerry_object_keys(answers);
+	uint32_t keys_length = jerry_array_length(keys);
+
+	for (uint32_t i = 0; i < keys_length; i++) {
+		jerry_value_t key = jerry_object_get_index(keys, i);
+		jerry_value_t value = jerry_object_get(answers, key);
+
+		uint32_t values_length = jerry_value_is_array(value) ? jerry_array_length(value) : 1;
+		ret = realloc(ret, (*size + values_length) * sizeof(struct static_answer));
+
+		for (uint32_t j = 0; j < values_length; j++) {
+			jerry_value_t answer = jerry_value_is_array(value) ? jerry_object_get_index(value, j) : jerry_value_copy(value);
+
+			struct resolve_result *result = isr_from_call_result(bindings, answer);
+			if (result->type == ANSWER) {
+				ret[*size].name = isr_from_jerry_string(key);
+				ret[*size].result = result;
+				(*size)++;
+			} else {
+				if (result->type == FORWARD) isr_script_report(jerry_throw_value(jerry_string_sz("staticAnswers may only hold Answers"), true));
+				isr_resolve_result_free(result);
+			}
+
+			jerry_value_free(answer);
+		}
+
+		jerry_value_free(value);
+		jerry_value_free(key);
+	}
+
+	jerry_value_free(keys);
+free_answers:
+	jerry_value_free(answers);
+	jerry_value_free(namespace);
 
 	return ret;
 }
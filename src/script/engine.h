@@ -9,35 +9,146 @@
 #define ISR_SCRIPT_ENGINE
 
 #include <jerryscript.h>
+#include <net/if.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 #include "module.h"
 #include "state.h"
 #include "../packet/question.h"
+#include "../packet/view.h"
 
-unsigned char *isr_from_jerry_typedarray(jerry_value_t jerry_typedarray, uint16_t *length);
-
-struct resolve_result_answer {
+struct resolve_result_record {
+	char *name; /* NULL meaning the question name */
 	uint16_t type;
+	bool has_ttl;
+	uint32_t ttl;
 	uint16_t rdlength;
-	unsigned char *rdata;
+	unsigned char *rdata; /* points into backing if it is an ArrayBuffer, else malloc'd */
+	jerry_value_t backing;
+};
+
+struct resolve_result_answer {
+	unsigned char rcode; /* NXDOMAIN for instance, with the SOA in authority */
+	struct resolve_result_record *records;
+	size_t records_length;
+	struct resolve_result_record *authority;
+	size_t authority_length;
+	struct resolve_result_record *additional;
+	size_t additional_length;
 };
 
 struct resolve_result_forward {
 	char *ip;	
 };
 
+/*
+	Optional cache hint given by the script, e.g.
+	new Answer(Type.A, rdata, { ttl: 60, depends: ["network"], scope: 24 })
+*/
+struct resolve_result_hint {
+	uint32_t ttl;
+	char **depends; /* state paths the decision depends on, NULL meaning the whole state */
+	size_t depends_length;
+	uint8_t scope; /* bits of question.client the decision depends on, 0 meaning none */
+};
+
 struct resolve_result {
-	enum { ANSWER, FORWARD, FALLBACK } type;
+	enum { ANSWER, FORWARD, FALLBACK, PENDING } type;
 	union {
 		struct resolve_result_answer *answer;
 		struct resolve_result_forward *forward;
+		jerry_value_t promise; /* what resolve() returned, not settled yet */
 	} value;
+	struct resolve_result_hint *hint;
+};
+
+void isr_resolve_result_answer_free(struct resolve_result_answer *answer);
+
+/*
+	Calls aborted for running past script_budget, counted against the script
+	whose code was running when the budget ran out.
+*/
+struct script_overrun {
+	struct script_overrun *next;
+	unsigned long count;
+	char script[];
+};
+
+struct script_stats {
+	unsigned long calls;
+	unsigned long budget_exceeded; /* calls aborted for running past script_budget */
+	struct script_overrun *overruns; /* the same by script, still owned by the engine */
+	uint64_t slowest; /* ms */
+};
+
+struct static_answer {
+	char *name;
+	struct resolve_result *result; /* always an ANSWER */
+};
+
+struct resolve_result *isr_resolve_result_copy(struct resolve_result *result);
+
+void isr_resolve_result_free(struct resolve_result *result);
+
+/*
+	Property names read or set on every query, made into strings once per context.
+*/
+enum script_string {
+	ISR_STRING_NAME,
+	ISR_STRING_TYPE,
+	ISR_STRING_CLASS,
+	ISR_STRING_RDATA,
+	ISR_STRING_IP,
+	ISR_STRING_TTL,
+	ISR_STRING_RCODE,
+	ISR_STRING_RECORDS,
+	ISR_STRING_AUTHORITY,
+	ISR_STRING_ADDITIONAL,
+	ISR_STRING_CACHE,
+	ISR_STRING_SCOPE,
+	ISR_STRING_DEPENDS,
+	ISR_STRING_TOUINT8ARRAY,
+	ISR_STRINGS
+};
+
+/*
+	Everything the query path needs from the loaded isr.js, looked up once at load
+	so that answering a query is building its arguments and calling resolve().
+*/
+struct script_bindings {
+	jerry_value_t module;
+	jerry_value_t resolve;
+	jerry_value_t resolve_batch; /* undefined if isr.js doesn't export resolveBatch() */
+	jerry_value_t answer; /* Answer and Forward of result.js */
+	jerry_value_t forward;
+	jerry_value_t question_proto;
+	jerry_value_t strings[ISR_STRINGS];
 };
 
 jerry_value_t isr_script_evaluate(const jerry_char_t *script, size_t script_size);
 
-struct resolve_result *isr_script_run(jerry_value_t module, struct question *question, struct state_provider **providers, size_t providers_size);
+jerry_value_t isr_script_load();
+
+void isr_script_report(jerry_value_t exception);
+
+struct resolve_result *isr_result_fallback(jerry_value_t exception);
+
+struct resolve_result *isr_result_failed();
+
+struct script_bindings *isr_script_bind(jerry_value_t module);
+
+void isr_script_unbind(struct script_bindings *bindings);
+
+void isr_script_stats(struct script_stats *stats);
+
+struct resolve_result *isr_script_result(struct script_bindings *bindings, struct question *question, jerry_value_t value, struct state_provider **providers, size_t providers_size, bool store);
+
+void isr_script_run_batch(struct script_bindings *bindings, struct question **questions, size_t count, struct state_provider **providers, size_t providers_size, struct resolve_result **results);
+
+void isr_script_jobs(size_t count);
+
+struct static_answer *isr_script_static_answers(struct script_bindings *bindings, size_t *size);
 
 #endif
@@ -1,4 +1,4 @@
-import { TextEncoder } from "util.js"
+import { ipv4, ipv6, domainName, characterString, txt, mx, srv, soa, concat } from "native/rdata"
 
 /* Special type to allow combination of multiple data */
 
@@ -8,16 +8,7 @@ export class Concat {
     }
 
     toUint8Array() {
-        let arrays = this.rdatas.map(x => x.toUint8Array());
-        let length = arrays.reduce((acc, c) => acc + c.length, 0);
-
-        let ret = new Uint8Array(length);
-        arrays.reduce((cursor, rdata) => {
-            ret.set(rdata, cursor);
-            return cursor + rdata.length;
-        }, 0);
-
-        return ret;
+        return concat(...this.rdatas);
     }
 }
 
@@ -34,6 +25,7 @@ export class RawRData {
 }
 
 /* Well-known RDATA formats, whose names and definitions implement their respective RFCs */
+/* Each is encoded and validated by native/rdata, throwing on malformed input */
 
 /* RFC 1035 */
 
@@ -43,11 +35,7 @@ export class CharacterString {
     }
 
     toUint8Array() {
-        let ret = new Uint8Array(this.str.length+1);
-        let encoder = new TextEncoder();
-        ret.set([this.str.length], 0);
-        ret.set(encoder.encode(this.str), 1);
-        return ret;
+        return characterString(this.str);
     }
 }
 
@@ -62,16 +50,7 @@ export class DomainName {
     }
 
     toUint8Array() {
-        let ret = new Uint8Array(this.str.length + 2);
-        let encoder = new TextEncoder();
-        let labels = this.str.split(".");
-        let last = labels.reduce((cursor, label) => {
-            ret.set([label.length], cursor);
-            ret.set(encoder.encode(label), cursor+1);
-            return cursor + label.length + 1;
-        }, 0);
-        ret.set([0], last);
-        return ret;
+        return domainName(this.str);
     }
 }
 
@@ -82,10 +61,74 @@ export class IPV4 {
     }
 
     toUint8Array() {
-        // TODO: implement validating & error throwing
-        let ret = new Uint8Array(4);
-        let octets = this.ip.split(".");
-        octets.forEach((octet, idx) => ret.set([parseInt(octet)], idx));
-        return ret;
+        return ipv4(this.ip);
+    }
+}
+
+/* RFC 3596 */
+export class IPV6 {
+    constructor(ip) {
+        this.ip = ip;
+    }
+
+    toUint8Array() {
+        return ipv6(this.ip);
+    }
+}
+
+/* RFC 1035 */
+export class MX {
+    constructor(preference, exchange) {
+        this.preference = preference;
+        this.exchange = new DomainName(exchange);
+    }
+
+    toUint8Array() {
+        return mx(this.preference, this.exchange.str);
+    }
+}
+
+/* RFC 1035 */
+export class PTR extends DomainName {}
+
+/* RFC 1035, each string being a character-string of its own */
+export class TXT {
+    constructor(...strs) {
+        this.strs = strs;
+    }
+
+    toUint8Array() {
+        return txt(...this.strs);
+    }
+}
+
+/* RFC 2782 */
+export class SRV {
+    constructor(priority, weight, port, target) {
+        this.priority = priority;
+        this.weight = weight;
+        this.port = port;
+        this.target = new DomainName(target);
+    }
+
+    toUint8Array() {
+        return srv(this.priority, this.weight, this.port, this.target.str);
+    }
+}
+
+/* RFC 1035 */
+export class SOA {
+    constructor(mname, rname, serial, refresh, retry, expire, minimum) {
+        this.mname = new DomainName(mname);
+        this.rname = new DomainName(rname);
+        this.serial = serial;
+        this.refresh = refresh;
+        this.retry = retry;
+        this.expire = expire;
+        this.minimum = minimum;
+    }
+
+    toUint8Array() {
+        return soa(this.mname.str, this.rname.str, this.serial, this.refresh, this.retry, this.expire, this.minimum);
     }
 }
@@ -1,12 +1,64 @@
-export class Answer {
-    constructor(type, rdata) {
+/*
+    cache is an optional hint allowing isr to skip resolve() for the same question:
+    { ttl: seconds, depends: ["state.path", ...] }
+    Leaving depends out means the decision depends on the whole state.
+    An answer that depends on question.client should give scope: bits, so it is only
+    reused for clients in the same network of that many bits.
+
+    An Answer holds either a single record, new Answer(type, rdata, cache),
+    or a whole RRset, new Answer([new Record(type, rdata), ...], cache).
+    Authority and additional records (NS, glue, ...) can be added with
+    withAuthority and withAdditional.
+*/
+
+export class Record {
+    constructor(type, rdata, ttl, name) {
         this.type = type;
         this.rdata = rdata;
+        this.ttl = ttl;
+        this.name = name;
+    }
+}
+
+export class Answer {
+    constructor(type, rdata, cache) {
+        if (Array.isArray(type)) {
+            this.records = type;
+            this.cache = rdata;
+        } else {
+            this.type = type;
+            this.rdata = rdata;
+            this.cache = cache;
+        }
+    }
+
+    withAuthority(...records) {
+        this.authority = records;
+        return this;
+    }
+
+    withAdditional(...records) {
+        this.additional = records;
+        return this;
+    }
+}
+
+/*
+    An answer without records: NXDOMAIN if nxdomain, otherwise NODATA (the name exists,
+    but not with the type asked). soa is the Record of type SOA of the zone,
+    without which downstream caches can't cache the negative answer (RFC 2308).
+*/
+export class Negative extends Answer {
+    constructor(nxdomain, soa, cache) {
+        super([], cache);
+        this.rcode = nxdomain ? 3 : 0;
+        this.authority = soa === undefined ? [] : [soa];
     }
 }
 
 export class Forward {
-    constructor(ip) {
+    constructor(ip, cache) {
         this.ip = ip;
+        this.cache = cache;
     }
 }
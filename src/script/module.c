@@ -27,6 +27,27 @@ bool isr_module_resolve_native(const jerry_value_t canonical_name, jerry_value_t
 			return true;
 		}
 		jerry_value_free(ret);
+	} else if (strcmp((char *) buff, "native/cache") == 0) {
+		jerry_value_t ret = isr_module_native_cache();
+		if (!jerry_value_is_exception(ret)) {
+			*result = ret;
+			return true;
+		}
+		jerry_value_free(ret);
+	} else if (strcmp((char *) buff, "native/rdata") == 0) {
+		jerry_value_t ret = isr_module_native_rdata();
+		if (!jerry_value_is_exception(ret)) {
+			*result = ret;
+			return true;
+		}
+		jerry_value_free(ret);
+	} else if (strcmp((char *) buff, "native/lookup") == 0) {
+		jerry_value_t ret = isr_module_native_lookup();
+		if (!jerry_value_is_exception(ret)) {
+			*result = ret;
+			return true;
+		}
+		jerry_value_free(ret);
 	}
 
 	return false;
@@ -38,7 +59,8 @@ bool isr_module_resolve_compiled_in(const jerry_value_t canonical_name, jerry_va
 	buff[size] = '\0';
 
 	jerry_parse_options_t opts;
-	opts.options = JERRY_PARSE_MODULE;
+	opts.options = JERRY_PARSE_MODULE | JERRY_PARSE_HAS_SOURCE_NAME;
+	opts.source_name = canonical_name;
 
 	if (strcmp((char *) buff, "rdata.js") == 0) {
 		jerry_value_t ret = jerry_parse(rdata_js, rdata_js_len, &opts);
@@ -84,8 +106,10 @@ jerry_value_t isr_module_get_canonical_name_file(const jerry_value_t name) {
 	jerry_value_t getter_script_dir = jerry_string_sz(isr_config.getter_script_dir);
 	jerry_value_t slash = jerry_string_sz("/");
 
-	jerry_value_t ret = jerry_binary_op(JERRY_BIN_OP_ADD, jerry_binary_op(JERRY_BIN_OP_ADD, getter_script_dir, slash), name);
+	jerry_value_t dir = jerry_binary_op(JERRY_BIN_OP_ADD, getter_script_dir, slash);
+	jerry_value_t ret = jerry_binary_op(JERRY_BIN_OP_ADD, dir, name);
 
+	jerry_value_free(dir);
 	jerry_value_free(getter_script_dir);
 	jerry_value_free(slash);
 
@@ -94,7 +118,7 @@ jerry_value_t isr_module_get_canonical_name_file(const jerry_value_t name) {
 
 bool isr_module_resolve_file(const jerry_value_t canonical_name, jerry_value_t *result) {
 	jerry_char_t buff[4097];
-	jerry_size_t size = jerry_string_to_buffer(canonical_name, JERRY_ENCODING_UTF8, buff, 4097);
+	jerry_size_t size = jerry_string_to_buffer(canonical_name, JERRY_ENCODING_UTF8, buff, 4096);
 	buff[size] = '\0';
 
 	FILE *file = fopen((char *)buff, "r");
@@ -109,24 +133,31 @@ bool isr_module_resolve_file(const jerry_value_t canonical_name, jerry_value_t *
 
 	jerry_char_t *script = malloc(sz * sizeof(jerry_char_t));
 	long script_sz = fread(script, 1, sz, file);
+	fclose(file);
+
+	/* Named relative to getter_script_dir, the way isr.js imports it, for the stats */
+	size_t dir_length = strlen(isr_config.getter_script_dir);
+	const char *name = strncmp((char *) buff, isr_config.getter_script_dir, dir_length) == 0 && buff[dir_length] == '/' ? (char *) buff + dir_length + 1 : (char *) buff;
 
 	jerry_parse_options_t opts;
-	opts.options = JERRY_PARSE_MODULE;
+	opts.options = JERRY_PARSE_MODULE | JERRY_PARSE_HAS_SOURCE_NAME;
+	opts.source_name = jerry_string_sz(name);
 
 	jerry_value_t ret = jerry_parse(script, script_sz, &opts);
+	jerry_value_free(opts.source_name);
 	free(script);
 	if (!jerry_value_is_exception(ret)) {
 		*result = ret;
 		return true;
 	}
-	jerry_value_free(ret);
 
 	jerry_value_t exception_val = jerry_exception_value(ret, true);
 	jerry_value_t str = jerry_value_to_string(exception_val);
 	jerry_value_free(exception_val);
+
 	jerry_size_t strsize = jerry_string_size(str, JERRY_ENCODING_UTF8);
-	jerry_char_t *err = malloc(strsize * sizeof(jerry_char_t));
-	jerry_size_t errsize = jerry_string_to_buffer(str, JERRY_ENCODING_UTF8, buff, jerry_string_size(str, JERRY_ENCODING_UTF8));
+	jerry_char_t *err = malloc((strsize + 1) * sizeof(jerry_char_t));
+	jerry_size_t errsize = jerry_string_to_buffer(str, JERRY_ENCODING_UTF8, err, strsize);
 	err[errsize] = '\0';
 	printf("isr: %s: %s\n", buff, err);
 
@@ -136,54 +167,175 @@ bool isr_module_resolve_file(const jerry_value_t canonical_name, jerry_value_t *
 	return false;
 }
 
-const jerryx_module_resolver_t **isr_module_resolvers(size_t *count) {
-	jerryx_module_resolver_t *native = malloc(sizeof(jerryx_module_resolver_t));
-	native->get_canonical_name_p = NULL;
-	native->resolve_p = &isr_module_resolve_native;
+const jerryx_module_resolver_t isr_module_native_resolver = {
+	.get_canonical_name_p = NULL,
+	.resolve_p = &isr_module_resolve_native,
+};
 
-	jerryx_module_resolver_t *compiled_in = malloc(sizeof(jerryx_module_resolver_t));
-	compiled_in->get_canonical_name_p = NULL;
-	compiled_in->resolve_p = &isr_module_resolve_compiled_in;
+const jerryx_module_resolver_t isr_module_compiled_in_resolver = {
+	.get_canonical_name_p = NULL,
+	.resolve_p = &isr_module_resolve_compiled_in,
+};
 
-	jerryx_module_resolver_t *file = malloc(sizeof(jerryx_module_resolver_t));
-	file->get_canonical_name_p = &isr_module_get_canonical_name_file;
-	file->resolve_p = &isr_module_resolve_file;
+const jerryx_module_resolver_t isr_module_file_resolver = {
+	.get_canonical_name_p = &isr_module_get_canonical_name_file,
+	.resolve_p = &isr_module_resolve_file,
+};
 
-	*count = 3;
-	const jerryx_module_resolver_t **ret = malloc(*count * sizeof(jerryx_module_resolver_t *));
-	ret[0] = native;
-	ret[1] = compiled_in;
-	ret[2] = file;
-	return ret;
+const jerryx_module_resolver_t *isr_module_resolvers[] = {
+	&isr_module_native_resolver,
+	&isr_module_compiled_in_resolver,
+	&isr_module_file_resolver,
+};
+
+/*
+	Modules of the current context by specifier, so each of them is parsed, linked
+	and evaluated once however many modules import it, and an import always yields
+	the same module, e.g. the one Answer every `instanceof Answer` is checked against.
+	Every specifier is relative to getter_script_dir, which makes it canonical
+	once a leading "./" is dropped.
+*/
+
+struct module_entry {
+	struct module_entry *next;
+	uint32_t hash;
+	jerry_value_t module;
+	char specifier[];
+};
+
+struct module_registry isr_module_registry;
+
+uint32_t isr_module_hash(const char *specifier) {
+	uint32_t hash = 2166136261u;
+	for (const char *c = specifier; *c != '\0'; c++) {
+		hash = (hash ^ (unsigned char) *c) * 16777619u;
+	}
+
+	return hash;
 }
 
-jerry_value_t isr_module_resolve_callback(const jerry_value_t specifier, const jerry_value_t referrer, void *user_p) {
-	size_t count;
-	const jerryx_module_resolver_t **resolvers = isr_module_resolvers(&count);
-	jerry_value_t ret = jerryx_module_resolve(specifier, resolvers, count);
+struct module_entry *isr_module_registry_find(const char *specifier, uint32_t hash) {
+	for (struct module_entry *entry = isr_module_registry.buckets[hash % ISR_MODULE_BUCKETS]; entry != NULL; entry = entry->next) {
+		if (entry->hash == hash && strcmp(entry->specifier, specifier) == 0) return entry;
+	}
 
-	return ret;
+	return NULL;
 }
 
-jerry_value_t isr_module_result() {
-	size_t count;
-	const jerryx_module_resolver_t **resolvers = isr_module_resolvers(&count);
+void isr_module_registry_free(struct module_registry *registry) {
+	for (size_t i = 0; i < ISR_MODULE_BUCKETS; i++) {
+		struct module_entry *entry = registry->buckets[i];
+		while (entry != NULL) {
+			struct module_entry *next = entry->next;
+			jerry_value_free(entry->module);
+			free(entry);
+			entry = next;
+		}
+		registry->buckets[i] = NULL;
+	}
+}
 
-	jerry_value_t resultn = jerry_string_sz("result.js");
-	jerry_value_t ret = jerryx_module_resolve(resultn, resolvers, count);
-	jerry_value_free(resultn);
+/*
+	Frees every module of the registry, which has to happen before jerry_cleanup.
+*/
+void isr_module_registry_clear() {
+	isr_module_registry_free(&isr_module_registry);
+}
 
-	return ret;
+/*
+	Exchanges the registry with other, so a new generation of scripts can be loaded
+	into an empty one while other keeps the modules still in use.
+*/
+void isr_module_registry_swap(struct module_registry *other) {
+	struct module_registry current = isr_module_registry;
+	isr_module_registry = *other;
+	*other = current;
 }
 
-jerry_value_t isr_module_state() {
-	size_t count;
-	const jerryx_module_resolver_t **resolvers = isr_module_resolvers(&count);
+/*
+	Returns the module for specifier, asking each resolver in turn the first time.
+*/
+jerry_value_t isr_module_resolve_sz(const char *specifier) {
+	if (strncmp(specifier, "./", 2) == 0) specifier += 2;
+
+	uint32_t hash = isr_module_hash(specifier);
+	struct module_entry *entry = isr_module_registry_find(specifier, hash);
+	if (entry != NULL) return jerry_value_copy(entry->module);
+
+	jerry_value_t name = jerry_string_sz(specifier);
+	jerry_value_t ret = jerry_undefined();
+	bool resolved = false;
 
-	jerry_value_t staten = jerry_string_sz("state.js");
-	jerry_value_t ret = jerryx_module_resolve(staten, resolvers, count);
-	jerry_value_free(staten);
+	for (size_t i = 0; i < sizeof(isr_module_resolvers) / sizeof(isr_module_resolvers[0]) && !resolved; i++) {
+		const jerryx_module_resolver_t *resolver = isr_module_resolvers[i];
+
+		jerry_value_t canonical_name = resolver->get_canonical_name_p != NULL ? resolver->get_canonical_name_p(name) : jerry_value_copy(name);
+		resolved = resolver->resolve_p(canonical_name, &ret);
+		jerry_value_free(canonical_name);
+	}
+
+	jerry_value_free(name);
+
+	if (!resolved) {
+		jerry_value_t message = jerry_string_sz("Module not found: ");
+		jerry_value_t specifierv = jerry_string_sz(specifier);
+		jerry_value_t messager = jerry_binary_op(JERRY_BIN_OP_ADD, message, specifierv);
+		jerry_value_free(specifierv);
+		jerry_value_free(message);
+
+		return jerry_throw_value(messager, true);
+	}
+
+	size_t length = strlen(specifier);
+	entry = malloc(sizeof(struct module_entry) + length + 1);
+	entry->hash = hash;
+	entry->module = jerry_value_copy(ret);
+	memcpy(entry->specifier, specifier, length + 1);
+
+	entry->next = isr_module_registry.buckets[hash % ISR_MODULE_BUCKETS];
+	isr_module_registry.buckets[hash % ISR_MODULE_BUCKETS] = entry;
 
 	return ret;
 }
 
+jerry_value_t isr_module_resolve_callback(const jerry_value_t specifier, const jerry_value_t referrer, void *user_p) {
+	char buff[4097];
+	jerry_size_t size = jerry_string_to_buffer(specifier, JERRY_ENCODING_UTF8, (jerry_char_t *) buff, sizeof(buff) - 1);
+	buff[size] = '\0';
+
+	return isr_module_resolve_sz(buff);
+}
+
+/*
+	Links and evaluates module unless an import of it already has.
+	Takes over module, returning it or the exception that stopped it.
+*/
+jerry_value_t isr_module_instantiate(jerry_value_t module) {
+	if (jerry_module_state(module) == JERRY_MODULE_STATE_UNLINKED) {
+		jerry_value_t linkr = jerry_module_link(module, &isr_module_resolve_callback, NULL);
+		if (jerry_value_is_exception(linkr)) { jerry_value_free(module); return linkr; }
+		jerry_value_free(linkr);
+	}
+
+	if (jerry_module_state(module) == JERRY_MODULE_STATE_LINKED) {
+		jerry_value_t evaluater = jerry_module_evaluate(module);
+		if (jerry_value_is_exception(evaluater)) { jerry_value_free(module); return evaluater; }
+		jerry_value_free(evaluater);
+	}
+
+	return module;
+}
+
+jerry_value_t isr_module_result() {
+	jerry_value_t ret = isr_module_resolve_sz("result.js");
+	if (jerry_value_is_exception(ret)) return ret;
+
+	return isr_module_instantiate(ret);
+}
+
+jerry_value_t isr_module_state() {
+	jerry_value_t ret = isr_module_resolve_sz("state.js");
+	if (jerry_value_is_exception(ret)) return ret;
+
+	return isr_module_instantiate(ret);
+}
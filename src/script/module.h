@@ -14,11 +14,30 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "native/cache.h"
 #include "native/encode.h"
+#include "native/lookup.h"
+#include "native/rdata.h"
 #include "../config.h"
 
+#define ISR_MODULE_BUCKETS 64
+
+struct module_registry {
+	struct module_entry *buckets[ISR_MODULE_BUCKETS];
+};
+
+void isr_module_registry_free(struct module_registry *registry);
+
+void isr_module_registry_clear();
+
+void isr_module_registry_swap(struct module_registry *other);
+
+jerry_value_t isr_module_resolve_sz(const char *specifier);
+
 jerry_value_t isr_module_resolve_callback(const jerry_value_t specifier, const jerry_value_t referrer, void *user_p);
 
+jerry_value_t isr_module_instantiate(jerry_value_t module);
+
 jerry_value_t isr_module_result();
 
 jerry_value_t isr_module_state();
@@ -0,0 +1,240 @@
+/*
+		Copyright (C) 2023
+			Pribess (Heewon Cho)
+			Jhyub	(Janghyub Seo)
+		src/script/native/cache.c
+*/
+
+#include "cache.h"
+
+#include "../../cache/decision.h"
+#include "../../cache/name.h"
+#include "../../cache/response.h"
+#include "../../cache/template.h"
+#include "../engine.h"
+#include "lookup.h"
+
+static char *isr_native_cache_string(jerry_value_t value) {
+	jerry_value_t string = jerry_value_to_string(value);
+	jerry_size_t size = jerry_string_size(string, JERRY_ENCODING_UTF8);
+
+	char *ret = malloc((size + 1) * sizeof(char));
+	jerry_size_t copied = jerry_string_to_buffer(string, JERRY_ENCODING_UTF8, (jerry_char_t *) ret, size);
+	jerry_value_free(string);
+	ret[copied] = '\0';
+
+	return ret;
+}
+
+static bool isr_native_cache_question(const jerry_value_t args_p[], const jerry_length_t args_cnt, struct question *question) {
+	if (args_cnt < 2 || !jerry_value_is_string(args_p[0]) || !jerry_value_is_number(args_p[1])) return false;
+
+	question->qname = isr_native_cache_string(args_p[0]);
+	question->qtype = jerry_value_as_uint32(args_p[1]);
+	question->qclass = args_cnt > 2 && jerry_value_is_number(args_p[2]) ? jerry_value_as_uint32(args_p[2]) : 1;
+	question->name = NULL;
+	question->subnet = NULL;
+	question->source = NULL;
+	question->view = NULL;
+
+	return true;
+}
+
+static jerry_value_t isr_native_cache_has(const jerry_call_info_t *call_info_p, const jerry_value_t args_p[], const jerry_length_t args_cnt) {
+	struct question question;
+	if (!isr_native_cache_question(args_p, args_cnt, &question)) return jerry_throw_value(jerry_string_sz("Called has with wrong parameters"), true);
+
+	bool ret = isr_response_cache_peek(&question) != NULL;
+	free(question.qname);
+
+	return jerry_boolean(ret);
+}
+
+static jerry_value_t isr_native_cache_get(const jerry_call_info_t *call_info_p, const jerry_value_t args_p[], const jerry_length_t args_cnt) {
+	struct question question;
+	if (!isr_native_cache_question(args_p, args_cnt, &question)) return jerry_throw_value(jerry_string_sz("Called get with wrong parameters"), true);
+
+	struct cached_response *cached = isr_response_cache_peek(&question);
+	free(question.qname);
+	if (cached == NULL) return jerry_undefined();
+
+	unsigned char *buff = malloc(cached->length * sizeof(unsigned char));
+	size_t length = isr_response_cache_copy(cached, buff, cached->length);
+
+	jerry_value_t arraybuffer = jerry_arraybuffer(length);
+	jerry_arraybuffer_write(arraybuffer, 0, buff, length);
+	free(buff);
+
+	jerry_value_t response = jerry_typedarray_with_buffer(JERRY_TYPEDARRAY_UINT8, arraybuffer);
+	jerry_value_free(arraybuffer);
+
+	jerry_value_t ttl = jerry_number(isr_response_cache_ttl(cached));
+
+	jerry_value_t ret = jerry_object();
+	jerry_value_free(jerry_object_set_sz(ret, "ttl", ttl));
+	jerry_value_free(jerry_object_set_sz(ret, "response", response));
+
+	jerry_value_free(ttl);
+	jerry_value_free(response);
+
+	return ret;
+}
+
+/*
+	put(name, type, rdata, ttl), rdata being either an RData object or an Uint8Array
+*/
+static jerry_value_t isr_native_cache_put(const jerry_call_info_t *call_info_p, const jerry_value_t args_p[], const jerry_length_t args_cnt) {
+	if (args_cnt != 4
+			|| !jerry_value_is_string(args_p[0])
+			|| !jerry_value_is_number(args_p[1])
+			|| !jerry_value_is_object(args_p[2])
+			|| !jerry_value_is_number(args_p[3]))
+		return jerry_throw_value(jerry_string_sz("Called put with wrong parameters"), true);
+
+	jerry_value_t typedarray;
+	if (jerry_value_is_typedarray(args_p[2])) {
+		typedarray = jerry_value_copy(args_p[2]);
+	} else {
+		jerry_value_t touint8array = jerry_object_get_sz(args_p[2], "toUint8Array");
+		if (!jerry_value_is_function(touint8array)) {
+			jerry_value_free(touint8array);
+			return jerry_throw_value(jerry_string_sz("rdata is neither RData nor Uint8Array"), true);
+		}
+
+		typedarray = jerry_call(touint8array, args_p[2], NULL, 0);
+		jerry_value_free(touint8array);
+		if (jerry_value_is_exception(typedarray)) return typedarray;
+	}
+
+	jerry_length_t offset, length;
+	jerry_value_t arraybuffer = jerry_typedarray_buffer(typedarray, &offset, &length);
+	jerry_value_free(typedarray);
+	if (jerry_value_is_exception(arraybuffer)) return arraybuffer;
+
+	if (length > UINT16_MAX) {
+		jerry_value_free(arraybuffer);
+		return jerry_throw_value(jerry_string_sz("rdata is too long"), true);
+	}
+
+	unsigned char *rdata = malloc((length + 1) * sizeof(unsigned char));
+	jerry_arraybuffer_read(arraybuffer, offset, rdata, length);
+	jerry_value_free(arraybuffer);
+
+	char *qname = isr_native_cache_string(args_p[0]);
+	bool ret = isr_response_cache_put(qname, jerry_value_as_uint32(args_p[1]), jerry_value_as_uint32(args_p[3]), rdata, length);
+	free(qname);
+	free(rdata);
+
+	return jerry_boolean(ret);
+}
+
+static jerry_value_t isr_native_cache_invalidate_common(const jerry_value_t args_p[], const jerry_length_t args_cnt, bool subtree) {
+	if (args_cnt != 1 || !jerry_value_is_string(args_p[0])) return jerry_throw_value(jerry_string_sz("Called invalidate with wrong parameters"), true);
+
+	char *qname = isr_native_cache_string(args_p[0]);
+	size_t ret = isr_response_cache_invalidate(qname, subtree) + isr_decision_invalidate(qname, subtree);
+	free(qname);
+
+	return jerry_number(ret);
+}
+
+static jerry_value_t isr_native_cache_invalidate(const jerry_call_info_t *call_info_p, const jerry_value_t args_p[], const jerry_length_t args_cnt) {
+	return isr_native_cache_invalidate_common(args_p, args_cnt, false);
+}
+
+static jerry_value_t isr_native_cache_invalidate_suffix(const jerry_call_info_t *call_info_p, const jerry_value_t args_p[], const jerry_length_t args_cnt) {
+	return isr_native_cache_invalidate_common(args_p, args_cnt, true);
+}
+
+static void isr_native_cache_stat(jerry_value_t object, const char *name, double value) {
+	jerry_value_t number = jerry_number(value);
+	jerry_value_free(jerry_object_set_sz(object, name, number));
+	jerry_value_free(number);
+}
+
+static jerry_value_t isr_native_cache_stats(const jerry_call_info_t *call_info_p, const jerry_value_t args_p[], const jerry_length_t args_cnt) {
+	struct response_cache_stats responses;
+	isr_response_cache_stats(&responses);
+
+	struct name_stats names;
+	isr_name_stats(&names);
+
+	struct script_stats script;
+	isr_script_stats(&script);
+
+	struct lookup_stats lookups;
+	isr_native_lookup_stats(&lookups);
+
+	jerry_value_t ret = jerry_object();
+	isr_native_cache_stat(ret, "entries", responses.entries);
+	isr_native_cache_stat(ret, "bytes", responses.bytes);
+	isr_native_cache_stat(ret, "hits", responses.hits);
+	isr_native_cache_stat(ret, "misses", responses.misses);
+	isr_native_cache_stat(ret, "evictions", responses.evictions);
+	isr_native_cache_stat(ret, "decisions", isr_decision_count());
+	isr_native_cache_stat(ret, "templates", isr_template_count());
+	isr_native_cache_stat(ret, "names", names.nodes);
+	isr_native_cache_stat(ret, "nameBytes", names.bytes);
+	isr_native_cache_stat(ret, "scriptCalls", script.calls);
+	isr_native_cache_stat(ret, "scriptBudgetExceeded", script.budget_exceeded);
+	isr_native_cache_stat(ret, "scriptSlowestMs", script.slowest);
+
+	jerry_value_t overruns = jerry_object();
+	for (struct script_overrun *overrun = script.overruns; overrun != NULL; overrun = overrun->next) {
+		isr_native_cache_stat(overruns, overrun->script, overrun->count);
+	}
+	jerry_value_free(jerry_object_set_sz(ret, "scriptBudgetExceededBy", overruns));
+	jerry_value_free(overruns);
+
+	isr_native_cache_stat(ret, "lookups", lookups.lookups);
+	isr_native_cache_stat(ret, "lookupHits", lookups.hits);
+	isr_native_cache_stat(ret, "lookupCoalesced", lookups.coalesced);
+	isr_native_cache_stat(ret, "lookupAnswered", lookups.answered);
+	isr_native_cache_stat(ret, "lookupTimeouts", lookups.timeouts);
+	isr_native_cache_stat(ret, "lookupMsTotal", lookups.total_ms);
+	isr_native_cache_stat(ret, "lookupSlowestMs", lookups.slowest_ms);
+	isr_native_cache_stat(ret, "lookupCached", lookups.cached);
+
+	return ret;
+}
+
+jerry_value_t isr_module_native_cache() {
+	const char *names[] = { "has", "get", "put", "invalidate", "invalidateSuffix", "stats" };
+	const jerry_external_handler_t handlers[] = {
+		&isr_native_cache_has,
+		&isr_native_cache_get,
+		&isr_native_cache_put,
+		&isr_native_cache_invalidate,
+		&isr_native_cache_invalidate_suffix,
+		&isr_native_cache_stats,
+	};
+	const size_t count = sizeof(handlers) / sizeof(handlers[0]);
+
+	jerry_value_t exports[sizeof(handlers) / sizeof(handlers[0])];
+	for (size_t i = 0; i < count; i++) {
+		exports[i] = jerry_string_sz(names[i]);
+	}
+
+	jerry_value_t ret = jerry_native_module(NULL, exports, count);
+	if (jerry_value_is_exception(ret)) goto free_exports;
+
+	for (size_t i = 0; i < count; i++) {
+		jerry_value_t val = jerry_function_external(handlers[i]);
+		jerry_value_t set = jerry_native_module_set(ret, exports[i], val);
+		jerry_value_free(val);
+
+		if (jerry_value_is_exception(set)) {
+			jerry_value_free(ret);
+			ret = set;
+			break;
+		}
+		jerry_value_free(set);
+	}
+
+free_exports:
+	for (size_t i = 0; i < count; i++) {
+		jerry_value_free(exports[i]);
+	}
+
+	return ret;
+}
@@ -0,0 +1,16 @@
+/*
+		Copyright (C) 2023
+			Pribess (Heewon Cho)
+			Jhyub	(Janghyub Seo)
+		src/script/native/cache.h
+*/
+
+#ifndef ISR_SCRIPT_NATIVE_CACHE
+#define ISR_SCRIPT_NATIVE_CACHE
+
+#include <jerryscript.h>
+#include <stdlib.h>
+
+jerry_value_t isr_module_native_cache();
+
+#endif
@@ -0,0 +1,400 @@
+/*
+		Copyright (C) 2023
+			Pribess (Heewon Cho)
+			Jhyub	(Janghyub Seo)
+		src/script/native/lookup.c
+*/
+
+#include "lookup.h"
+
+#include "../../clock.h"
+#include "../../forward.h"
+#include "../../packet/writer.h"
+
+/*
+	lookup(name, type, upstream) asks upstream through isr's forwarder and returns a Promise of
+	{ rcode, answers: [{ name, type, ttl, rdata, address, target }], cached, elapsed }.
+	Replies are cached by question and upstream for as long as their TTLs allow, apart from
+	the response cache, whose entries are what isr answered clients with and say nothing
+	of any one upstream. Lookups of one question at one upstream share a single query
+	while it is in flight.
+*/
+
+#define ISR_LOOKUP_CACHE_BUCKETS 256
+#define ISR_LOOKUP_CACHE_SIZE 1024 /* replies cached at most, the cache starting over when full */
+
+struct lookup {
+	struct lookup *next;
+	char qname[256];
+	uint16_t qtype;
+	char upstream[INET_ADDRSTRLEN];
+	uint64_t started;
+	jerry_value_t *promises;
+	size_t promises_length;
+};
+
+static struct lookup *lookups = NULL;
+
+struct lookup_cached {
+	struct lookup_cached *next;
+	char qname[256]; /* lowercased */
+	uint16_t qtype;
+	char upstream[INET_ADDRSTRLEN];
+	uint32_t hash;
+	uint64_t stored;
+	uint64_t expire;
+	size_t length;
+	unsigned char wire[];
+};
+
+static struct lookup_cached *lookup_cache[ISR_LOOKUP_CACHE_BUCKETS];
+static size_t lookup_cache_size = 0;
+
+static struct lookup_stats lookup_stats;
+
+static void isr_native_lookup_set(jerry_value_t object, const char *name, jerry_value_t value) {
+	jerry_value_free(jerry_object_set_sz(object, name, value));
+	jerry_value_free(value);
+}
+
+static bool isr_native_lookup_string(jerry_value_t value, char *buff, size_t size) {
+	if (!jerry_value_is_string(value)) return false;
+
+	jerry_size_t string_size = jerry_string_size(value, JERRY_ENCODING_UTF8);
+	if (string_size >= size) return false;
+
+	buff[jerry_string_to_buffer(value, JERRY_ENCODING_UTF8, (jerry_char_t *) buff, string_size)] = '\0';
+
+	return true;
+}
+
+/*
+	Turns the answer section of response into { rcode, answers, cached, elapsed }.
+	address is set on A and AAAA records, target on those whose rdata is a single name.
+*/
+static jerry_value_t isr_native_lookup_result(struct packet_view *response, bool cached, uint64_t elapsed) {
+	jerry_value_t ret = jerry_object();
+	isr_native_lookup_set(ret, "rcode", jerry_number(response->header.rcode));
+	isr_native_lookup_set(ret, "cached", jerry_boolean(cached));
+	isr_native_lookup_set(ret, "elapsed", jerry_number(elapsed));
+
+	jerry_value_t answers = jerry_array(0);
+	size_t cursor = 12 + response->question_length;
+
+	for (uint32_t i = 0; i < response->header.ancount; i++) {
+		char name[256];
+		if (!isr_view_name(response->packet, response->size, &cursor, name) || cursor + 10 > response->size) break;
+
+		uint16_t type = ntohs(*(uint16_t *)(response->packet + cursor));
+		uint32_t ttl = ntohl(*(uint32_t *)(response->packet + cursor + 4));
+		uint16_t rdlength = ntohs(*(uint16_t *)(response->packet + cursor + 8));
+		size_t rdata = cursor + 10;
+		if (rdata + rdlength > response->size) break;
+
+		jerry_value_t record = jerry_object();
+		isr_native_lookup_set(record, "name", jerry_string_sz(name));
+		isr_native_lookup_set(record, "type", jerry_number(type));
+		isr_native_lookup_set(record, "ttl", jerry_number(ttl));
+
+		jerry_value_t rdatav = jerry_typedarray(JERRY_TYPEDARRAY_UINT8, rdlength);
+		jerry_length_t offset, length;
+		jerry_value_t buffer = jerry_typedarray_buffer(rdatav, &offset, &length);
+		if (rdlength > 0) memcpy(jerry_arraybuffer_data(buffer) + offset, response->packet + rdata, rdlength);
+		jerry_value_free(buffer);
+		isr_native_lookup_set(record, "rdata", rdatav);
+
+		char address[INET6_ADDRSTRLEN];
+		if ((type == 1 && rdlength == 4) || (type == 28 && rdlength == 16)) {
+			inet_ntop(type == 1 ? AF_INET : AF_INET6, response->packet + rdata, address, sizeof(address));
+			isr_native_lookup_set(record, "address", jerry_string_sz(address));
+		}
+
+		/* NS, CNAME and PTR, whose names may be compressed against the rest of the message */
+		size_t target_cursor = rdata;
+		char target[256];
+		if ((type == 2 || type == 5 || type == 12) && isr_view_name(response->packet, response->size, &target_cursor, target)) {
+			isr_native_lookup_set(record, "target", jerry_string_sz(target));
+		}
+
+		jerry_value_free(jerry_object_set_index(answers, i, record));
+		jerry_value_free(record);
+
+		cursor = rdata + rdlength;
+	}
+
+	isr_native_lookup_set(ret, "answers", answers);
+
+	return ret;
+}
+
+static uint32_t isr_native_lookup_hash(const char *qname, uint16_t qtype, const char *upstream) {
+	uint32_t ret = 2166136261u ^ qtype;
+	for (const char *c = qname; *c != '\0'; c++) ret = (ret ^ (unsigned char) *c) * 16777619u;
+	for (const char *c = upstream; *c != '\0'; c++) ret = (ret ^ (unsigned char) *c) * 16777619u;
+
+	return ret;
+}
+
+static void isr_native_lookup_lower(const char *qname, char *lower) {
+	size_t i = 0;
+	for (; qname[i] != '\0'; i++) lower[i] = tolower((unsigned char) qname[i]);
+	lower[i] = '\0';
+}
+
+static void isr_native_lookup_flush() {
+	for (size_t i = 0; i < ISR_LOOKUP_CACHE_BUCKETS; i++) {
+		while (lookup_cache[i] != NULL) {
+			struct lookup_cached *cached = lookup_cache[i];
+			lookup_cache[i] = cached->next;
+			free(cached);
+		}
+	}
+
+	lookup_cache_size = 0;
+}
+
+/*
+	Finds the reply cached for qname and qtype at upstream, dropping it if it has expired.
+*/
+static struct lookup_cached *isr_native_lookup_cached(const char *qname, uint16_t qtype, const char *upstream) {
+	char lower[256];
+	isr_native_lookup_lower(qname, lower);
+
+	uint32_t hash = isr_native_lookup_hash(lower, qtype, upstream);
+	for (struct lookup_cached **link = &lookup_cache[hash % ISR_LOOKUP_CACHE_BUCKETS]; *link != NULL; link = &(*link)->next) {
+		struct lookup_cached *cached = *link;
+		if (cached->hash != hash || cached->qtype != qtype || strcmp(cached->qname, lower) != 0 || strcmp(cached->upstream, upstream) != 0) continue;
+
+		if (isr_clock_ms() < cached->expire) return cached;
+
+		*link = cached->next;
+		free(cached);
+		lookup_cache_size--;
+		return NULL;
+	}
+
+	return NULL;
+}
+
+/*
+	Caches upstream's reply to lookup until the lowest TTL in it runs out. Like the response cache,
+	negative answers are only cached if they carry an SOA, and truncated ones never are.
+*/
+static void isr_native_lookup_store(struct lookup *lookup, struct packet_view *response) {
+	if (response->header.tc) return;
+	if (response->header.rcode == 0 && response->header.ancount == 0 && response->header.nscount == 0) return;
+	if (response->header.rcode != 0 && (response->header.rcode != 3 || response->header.nscount == 0)) return;
+
+	uint16_t ttl_offsets[ISR_WRITER_TTLS];
+	size_t ttl_offsets_length;
+	if (!isr_view_ttls(response, ttl_offsets, &ttl_offsets_length, ISR_WRITER_TTLS) || ttl_offsets_length == 0) return;
+
+	uint32_t ttl = UINT32_MAX;
+	for (size_t i = 0; i < ttl_offsets_length; i++) {
+		uint32_t record_ttl = ntohl(*(uint32_t *)(response->packet + ttl_offsets[i]));
+		if (record_ttl < ttl) ttl = record_ttl;
+	}
+	if (ttl == 0) return;
+
+	if (isr_native_lookup_cached(lookup->qname, lookup->qtype, lookup->upstream) != NULL) return;
+	if (lookup_cache_size >= ISR_LOOKUP_CACHE_SIZE) isr_native_lookup_flush();
+
+	struct lookup_cached *cached = malloc(sizeof(struct lookup_cached) + response->size);
+	isr_native_lookup_lower(lookup->qname, cached->qname);
+	cached->qtype = lookup->qtype;
+	strcpy(cached->upstream, lookup->upstream);
+	cached->hash = isr_native_lookup_hash(cached->qname, cached->qtype, cached->upstream);
+	cached->stored = isr_clock_ms();
+	cached->expire = cached->stored + (uint64_t) ttl * 1000;
+	cached->length = response->size;
+	memcpy(cached->wire, response->packet, response->size);
+
+	cached->next = lookup_cache[cached->hash % ISR_LOOKUP_CACHE_BUCKETS];
+	lookup_cache[cached->hash % ISR_LOOKUP_CACHE_BUCKETS] = cached;
+	lookup_cache_size++;
+}
+
+/*
+	The result of a cached reply, its TTLs counted down by the time it has been cached.
+	Returns false if the reply somehow doesn't parse.
+*/
+static bool isr_native_lookup_serve(struct lookup_cached *cached, jerry_value_t *result) {
+	unsigned char *wire = malloc(cached->length);
+	memcpy(wire, cached->wire, cached->length);
+
+	struct packet_view response;
+	uint16_t ttl_offsets[ISR_WRITER_TTLS];
+	size_t ttl_offsets_length;
+	if (!isr_view_parse(&response, wire, cached->length) || !isr_view_ttls(&response, ttl_offsets, &ttl_offsets_length, ISR_WRITER_TTLS)) {
+		free(wire);
+		return false;
+	}
+
+	uint32_t age = (isr_clock_ms() - cached->stored) / 1000;
+	for (size_t i = 0; i < ttl_offsets_length; i++) {
+		uint32_t ttl = ntohl(*(uint32_t *)(wire + ttl_offsets[i]));
+		*(uint32_t *)(wire + ttl_offsets[i]) = htonl(ttl > age ? ttl - age : 0);
+	}
+
+	*result = isr_native_lookup_result(&response, true, 0);
+	free(wire);
+
+	return true;
+}
+
+void isr_native_lookup_stats(struct lookup_stats *stats) {
+	*stats = lookup_stats;
+	stats->cached = lookup_cache_size;
+}
+
+/*
+	Settles every promise waiting on lookup with upstream's reply, or rejects them if there was none.
+*/
+static void isr_native_lookup_done(struct forward *forward, struct packet_view *response) {
+	struct lookup *lookup = forward->user;
+
+	for (struct lookup **link = &lookups; *link != NULL; link = &(*link)->next) {
+		if (*link == lookup) { *link = lookup->next; break; }
+	}
+
+	uint64_t elapsed = isr_clock_ms() - lookup->started;
+	if (response != NULL) {
+		lookup_stats.answered++;
+		lookup_stats.total_ms += elapsed;
+		if (elapsed > lookup_stats.slowest_ms) lookup_stats.slowest_ms = elapsed;
+
+		isr_native_lookup_store(lookup, response);
+	} else {
+		lookup_stats.timeouts++;
+	}
+
+	jerry_value_t result = response != NULL
+		? isr_native_lookup_result(response, false, elapsed)
+		: jerry_string_sz("lookup timed out");
+
+	for (size_t i = 0; i < lookup->promises_length; i++) {
+		jerry_value_t settler = response != NULL ? jerry_promise_resolve(lookup->promises[i], result) : jerry_promise_reject(lookup->promises[i], result);
+		jerry_value_free(settler);
+		jerry_value_free(lookup->promises[i]);
+	}
+
+	jerry_value_free(result);
+	free(lookup->promises);
+	free(lookup);
+}
+
+static struct lookup *isr_native_lookup_find(const char *qname, uint16_t qtype, const char *upstream) {
+	for (struct lookup *lookup = lookups; lookup != NULL; lookup = lookup->next) {
+		if (lookup->qtype == qtype && strcasecmp(lookup->qname, qname) == 0 && strcmp(lookup->upstream, upstream) == 0) return lookup;
+	}
+
+	return NULL;
+}
+
+/*
+	Sends the query for qname and qtype to upstream, returning the lookup waiting on it.
+*/
+static struct lookup *isr_native_lookup_start(char *qname, uint16_t qtype, const char *upstream) {
+	struct question question = {
+		.qname = qname,
+		.qtype = qtype,
+		.qclass = 1,
+		.name = NULL,
+	};
+
+	unsigned char query[512];
+	struct packet_writer writer;
+	isr_writer_init(&writer, query, sizeof(query));
+
+	struct header header = { .rd = 1, .qdcount = 0 };
+	isr_writer_header(&writer, &header);
+	isr_writer_question(&writer, &question);
+
+	struct packet_view view;
+	if (!isr_view_parse(&view, query, isr_writer_finish(&writer))) return NULL;
+
+	struct lookup *lookup = malloc(sizeof(struct lookup));
+	strcpy(lookup->qname, qname);
+	lookup->qtype = qtype;
+	strcpy(lookup->upstream, upstream);
+	lookup->started = isr_clock_ms();
+	lookup->promises = NULL;
+	lookup->promises_length = 0;
+
+	if (!isr_forward_lookup(&view, upstream, &isr_native_lookup_done, lookup)) {
+		free(lookup);
+		return NULL;
+	}
+
+	lookup->next = lookups;
+	lookups = lookup;
+
+	return lookup;
+}
+
+static jerry_value_t isr_native_lookup(const jerry_call_info_t *call_info_p, const jerry_value_t args_p[], const jerry_length_t args_cnt) {
+	char qname[256];
+	char upstream[INET_ADDRSTRLEN];
+	struct in_addr upstream_addr;
+
+	if (args_cnt < 3 || !isr_native_lookup_string(args_p[0], qname, sizeof(qname)) || !jerry_value_is_number(args_p[1])
+			|| !isr_native_lookup_string(args_p[2], upstream, sizeof(upstream)) || inet_pton(AF_INET, upstream, &upstream_addr) != 1) {
+		return jerry_throw_value(jerry_string_sz("Called lookup with wrong parameters"), true);
+	}
+
+	size_t qname_length = strlen(qname);
+	if (qname_length > 0 && qname[qname_length - 1] == '.') qname[qname_length - 1] = '\0';
+
+	uint16_t qtype = jerry_value_as_uint32(args_p[1]);
+
+	jerry_value_t ret = jerry_promise();
+	lookup_stats.lookups++;
+
+	struct lookup_cached *cached = isr_native_lookup_cached(qname, qtype, upstream);
+	jerry_value_t result;
+	if (cached != NULL && isr_native_lookup_serve(cached, &result)) {
+		lookup_stats.hits++;
+		jerry_value_free(jerry_promise_resolve(ret, result));
+		jerry_value_free(result);
+
+		return ret;
+	}
+
+	struct lookup *lookup = isr_native_lookup_find(qname, qtype, upstream);
+	if (lookup != NULL) lookup_stats.coalesced++;
+	else lookup = isr_native_lookup_start(qname, qtype, upstream);
+
+	if (lookup == NULL) {
+		jerry_value_t reason = jerry_string_sz("lookup couldn't reach upstream");
+		jerry_value_free(jerry_promise_reject(ret, reason));
+		jerry_value_free(reason);
+
+		return ret;
+	}
+
+	lookup->promises = realloc(lookup->promises, (lookup->promises_length + 1) * sizeof(jerry_value_t));
+	lookup->promises[lookup->promises_length++] = jerry_value_copy(ret);
+
+	return ret;
+}
+
+jerry_value_t isr_module_native_lookup() {
+	const jerry_value_t exports[1] = {
+		jerry_string_sz("lookup"),
+	};
+
+	jerry_value_t ret = jerry_native_module(NULL, exports, 1);
+
+	jerry_value_t val0 = jerry_function_external(&isr_native_lookup);
+	if (jerry_value_is_exception(val0)) { ret = val0; goto free_pre_val0; }
+	jerry_value_t set0 = jerry_native_module_set(ret, exports[0], val0);
+	if (jerry_value_is_exception(set0)) { ret = set0; goto free_pre_set0; }
+
+	jerry_value_free(set0);
+free_pre_set0:
+	jerry_value_free(val0);
+free_pre_val0:
+	jerry_value_free(exports[0]);
+
+	return ret;
+}
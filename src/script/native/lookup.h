@@ -0,0 +1,39 @@
+/*
+		Copyright (C) 2023
+			Pribess (Heewon Cho)
+			Jhyub	(Janghyub Seo)
+		src/script/native/lookup.h
+*/
+
+#ifndef ISR_SCRIPT_NATIVE_LOOKUP
+#define ISR_SCRIPT_NATIVE_LOOKUP
+
+#include <arpa/inet.h>
+#include <ctype.h>
+#include <jerryscript.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+/*
+	What lookup() has done since isr started. Upstream time is only that of queries
+	actually sent and answered, cache hits and joined queries taking none.
+*/
+struct lookup_stats {
+	unsigned long lookups;
+	unsigned long hits; /* answered from the lookup cache */
+	unsigned long coalesced; /* joined a query to the same upstream already in flight */
+	unsigned long answered;
+	unsigned long timeouts;
+	uint64_t total_ms;
+	uint64_t slowest_ms;
+	size_t cached; /* replies in the lookup cache */
+};
+
+void isr_native_lookup_stats(struct lookup_stats *stats);
+
+jerry_value_t isr_module_native_lookup();
+
+#endif
@@ -0,0 +1,318 @@
+/*
+		Copyright (C) 2023
+			Pribess (Heewon Cho)
+			Jhyub	(Janghyub Seo)
+		src/script/native/rdata.c
+*/
+
+#include "rdata.h"
+
+#define ISR_RDATA_NAME_MAX 255
+
+/*
+	Copies value into buff if it is a string of less than size octets of UTF-8.
+*/
+static bool isr_native_rdata_string(jerry_value_t value, char *buff, size_t size, size_t *length) {
+	if (!jerry_value_is_string(value)) return false;
+
+	jerry_size_t string_size = jerry_string_size(value, JERRY_ENCODING_UTF8);
+	if (string_size >= size) return false;
+
+	*length = jerry_string_to_buffer(value, JERRY_ENCODING_UTF8, (jerry_char_t *) buff, string_size);
+	buff[*length] = '\0';
+
+	return true;
+}
+
+static bool isr_native_rdata_number(jerry_value_t value, uint32_t max, uint32_t *out) {
+	if (!jerry_value_is_number(value)) return false;
+
+	double number = jerry_value_as_number(value);
+	if (!(number >= 0 && number <= max) || number != (double) (uint32_t) number) return false;
+
+	*out = (uint32_t) number;
+	return true;
+}
+
+/*
+	Writes name, with or without its trailing dot, to out in wire format.
+	Returns the length written, or 0 if name isn't a valid domain name.
+*/
+static size_t isr_native_rdata_name(const char *name, size_t length, unsigned char *out) {
+	if (length > 0 && name[length - 1] == '.') length--;
+	if (length > 0 && name[length - 1] == '.') return 0;
+
+	size_t written = 0;
+	size_t start = 0;
+	while (start < length) {
+		const char *dot = memchr(name + start, '.', length - start);
+		size_t end = dot != NULL ? (size_t) (dot - name) : length;
+		size_t label = end - start;
+		if (label == 0 || label > 63 || written + label + 2 > ISR_RDATA_NAME_MAX) return 0;
+
+		out[written++] = label;
+		memcpy(out + written, name + start, label);
+		written += label;
+
+		start = end + 1;
+	}
+
+	out[written++] = 0;
+	return written;
+}
+
+/*
+	Reads a name argument and writes it to out, which holds ISR_RDATA_NAME_MAX octets.
+*/
+static size_t isr_native_rdata_name_value(jerry_value_t value, unsigned char *out) {
+	char buff[ISR_RDATA_NAME_MAX + 2];
+	size_t length;
+	if (!isr_native_rdata_string(value, buff, sizeof(buff), &length)) return 0;
+
+	return isr_native_rdata_name(buff, length, out);
+}
+
+/*
+	Returns a Uint8Array of length octets, pointing *data at them.
+*/
+static jerry_value_t isr_native_rdata_array(size_t length, unsigned char **data) {
+	jerry_value_t ret = jerry_typedarray(JERRY_TYPEDARRAY_UINT8, length);
+	if (jerry_value_is_exception(ret)) return ret;
+
+	jerry_length_t offset, buff_length;
+	jerry_value_t buff = jerry_typedarray_buffer(ret, &offset, &buff_length);
+	*data = jerry_arraybuffer_data(buff) + offset;
+	jerry_value_free(buff);
+
+	return ret;
+}
+
+static jerry_value_t isr_native_rdata_copy(const unsigned char *rdata, size_t length) {
+	unsigned char *data;
+	jerry_value_t ret = isr_native_rdata_array(length, &data);
+	if (!jerry_value_is_exception(ret)) memcpy(data, rdata, length);
+
+	return ret;
+}
+
+static jerry_value_t isr_native_rdata_address(const jerry_value_t args_p[], const jerry_length_t args_cnt, int family, const char *message) {
+	char buff[INET6_ADDRSTRLEN];
+	size_t length;
+	unsigned char address[16];
+
+	if (args_cnt != 1 || !isr_native_rdata_string(args_p[0], buff, sizeof(buff), &length) || inet_pton(family, buff, address) != 1) {
+		return jerry_throw_value(jerry_string_sz(message), true);
+	}
+
+	return isr_native_rdata_copy(address, family == AF_INET6 ? 16 : 4);
+}
+
+static jerry_value_t isr_native_rdata_ipv4(const jerry_call_info_t *call_info_p, const jerry_value_t args_p[], const jerry_length_t args_cnt) {
+	return isr_native_rdata_address(args_p, args_cnt, AF_INET, "IPV4 takes an IPv4 address");
+}
+
+static jerry_value_t isr_native_rdata_ipv6(const jerry_call_info_t *call_info_p, const jerry_value_t args_p[], const jerry_length_t args_cnt) {
+	return isr_native_rdata_address(args_p, args_cnt, AF_INET6, "IPV6 takes an IPv6 address");
+}
+
+static jerry_value_t isr_native_rdata_domain_name(const jerry_call_info_t *call_info_p, const jerry_value_t args_p[], const jerry_length_t args_cnt) {
+	unsigned char rdata[ISR_RDATA_NAME_MAX];
+	size_t length = args_cnt == 1 ? isr_native_rdata_name_value(args_p[0], rdata) : 0;
+	if (length == 0) return jerry_throw_value(jerry_string_sz("DomainName takes a domain name"), true);
+
+	return isr_native_rdata_copy(rdata, length);
+}
+
+static jerry_value_t isr_native_rdata_character_string(const jerry_call_info_t *call_info_p, const jerry_value_t args_p[], const jerry_length_t args_cnt) {
+	unsigned char rdata[257];
+	size_t length;
+	if (args_cnt != 1 || !isr_native_rdata_string(args_p[0], (char *) rdata + 1, sizeof(rdata) - 1, &length)) {
+		return jerry_throw_value(jerry_string_sz("CharacterString takes a string of at most 255 octets"), true);
+	}
+
+	rdata[0] = length;
+	return isr_native_rdata_copy(rdata, length + 1);
+}
+
+/*
+	TXT is any number of character strings back to back.
+*/
+static jerry_value_t isr_native_rdata_txt(const jerry_call_info_t *call_info_p, const jerry_value_t args_p[], const jerry_length_t args_cnt) {
+	size_t length = 0;
+	for (jerry_length_t i = 0; i < args_cnt; i++) {
+		if (!jerry_value_is_string(args_p[i])) return jerry_throw_value(jerry_string_sz("TXT takes strings"), true);
+
+		jerry_size_t size = jerry_string_size(args_p[i], JERRY_ENCODING_UTF8);
+		if (size > 255) return jerry_throw_value(jerry_string_sz("TXT strings are at most 255 octets"), true);
+
+		length += size + 1;
+	}
+	if (args_cnt == 0 || length > UINT16_MAX) return jerry_throw_value(jerry_string_sz("TXT takes 1 to 65535 octets of strings"), true);
+
+	unsigned char *data;
+	jerry_value_t ret = isr_native_rdata_array(length, &data);
+	if (jerry_value_is_exception(ret)) return ret;
+
+	for (jerry_length_t i = 0; i < args_cnt; i++) {
+		jerry_size_t size = jerry_string_size(args_p[i], JERRY_ENCODING_UTF8);
+		*data = size;
+		data += jerry_string_to_buffer(args_p[i], JERRY_ENCODING_UTF8, data + 1, size) + 1;
+	}
+
+	return ret;
+}
+
+static jerry_value_t isr_native_rdata_mx(const jerry_call_info_t *call_info_p, const jerry_value_t args_p[], const jerry_length_t args_cnt) {
+	unsigned char rdata[2 + ISR_RDATA_NAME_MAX];
+	uint32_t preference;
+	size_t length;
+
+	if (args_cnt != 2 || !isr_native_rdata_number(args_p[0], UINT16_MAX, &preference) || (length = isr_native_rdata_name_value(args_p[1], rdata + 2)) == 0) {
+		return jerry_throw_value(jerry_string_sz("MX takes a preference and a domain name"), true);
+	}
+
+	*(uint16_t *)rdata = htons(preference);
+	return isr_native_rdata_copy(rdata, 2 + length);
+}
+
+static jerry_value_t isr_native_rdata_srv(const jerry_call_info_t *call_info_p, const jerry_value_t args_p[], const jerry_length_t args_cnt) {
+	unsigned char rdata[6 + ISR_RDATA_NAME_MAX];
+	uint32_t fields[3];
+	size_t length = 0;
+
+	bool valid = args_cnt == 4;
+	for (size_t i = 0; valid && i < 3; i++) {
+		valid = isr_native_rdata_number(args_p[i], UINT16_MAX, &fields[i]);
+	}
+	if (valid) length = isr_native_rdata_name_value(args_p[3], rdata + 6);
+	if (length == 0) return jerry_throw_value(jerry_string_sz("SRV takes a priority, weight, port and a domain name"), true);
+
+	for (size_t i = 0; i < 3; i++) {
+		*(uint16_t *)(rdata + i * 2) = htons(fields[i]);
+	}
+
+	return isr_native_rdata_copy(rdata, 6 + length);
+}
+
+static jerry_value_t isr_native_rdata_soa(const jerry_call_info_t *call_info_p, const jerry_value_t args_p[], const jerry_length_t args_cnt) {
+	unsigned char rdata[ISR_RDATA_NAME_MAX * 2 + 20];
+	size_t mname_length = 0, rname_length = 0;
+	uint32_t timers[5];
+
+	bool valid = args_cnt == 7;
+	for (size_t i = 0; valid && i < 5; i++) {
+		valid = isr_native_rdata_number(args_p[2 + i], UINT32_MAX, &timers[i]);
+	}
+	if (valid) mname_length = isr_native_rdata_name_value(args_p[0], rdata);
+	if (mname_length != 0) rname_length = isr_native_rdata_name_value(args_p[1], rdata + mname_length);
+	if (rname_length == 0) return jerry_throw_value(jerry_string_sz("SOA takes two domain names and five 32-bit timers"), true);
+
+	unsigned char *cursor = rdata + mname_length + rname_length;
+	for (size_t i = 0; i < 5; i++) {
+		*(uint32_t *)(cursor + i * 4) = htonl(timers[i]);
+	}
+
+	return isr_native_rdata_copy(rdata, mname_length + rname_length + 20);
+}
+
+/*
+	Concatenates rdata objects and Uint8Arrays, calling toUint8Array() on the former.
+*/
+static jerry_value_t isr_native_rdata_concat(const jerry_call_info_t *call_info_p, const jerry_value_t args_p[], const jerry_length_t args_cnt) {
+	jerry_value_t ret;
+
+	jerry_value_t *arrays = malloc((args_cnt + 1) * sizeof(jerry_value_t));
+	jerry_length_t arrays_length = 0;
+	size_t length = 0;
+
+	for (jerry_length_t i = 0; i < args_cnt; i++) {
+		jerry_value_t array;
+
+		if (jerry_value_is_typedarray(args_p[i])) {
+			array = jerry_value_copy(args_p[i]);
+		} else {
+			jerry_value_t touint8array = jerry_object_get_sz(args_p[i], "toUint8Array");
+			array = jerry_value_is_function(touint8array) ? jerry_call(touint8array, args_p[i], NULL, 0) : jerry_undefined();
+			jerry_value_free(touint8array);
+		}
+
+		if (jerry_value_is_exception(array)) { ret = array; goto free_arrays; }
+		arrays[arrays_length++] = array;
+
+		if (!jerry_value_is_typedarray(array) || jerry_typedarray_type(array) != JERRY_TYPEDARRAY_UINT8) {
+			ret = jerry_throw_value(jerry_string_sz("Concat takes rdata and Uint8Arrays"), true);
+			goto free_arrays;
+		}
+
+		length += jerry_typedarray_length(array);
+	}
+
+	if (length > UINT16_MAX) { ret = jerry_throw_value(jerry_string_sz("rdata is longer than 65535 octets"), true); goto free_arrays; }
+
+	unsigned char *data;
+	ret = isr_native_rdata_array(length, &data);
+	if (jerry_value_is_exception(ret)) goto free_arrays;
+
+	for (jerry_length_t i = 0; i < arrays_length; i++) {
+		jerry_length_t offset, buff_length;
+		jerry_value_t buff = jerry_typedarray_buffer(arrays[i], &offset, &buff_length);
+
+		uint8_t *from = jerry_arraybuffer_data(buff);
+		if (from != NULL) memcpy(data, from + offset, buff_length);
+		data += buff_length;
+
+		jerry_value_free(buff);
+	}
+
+free_arrays:
+	for (jerry_length_t i = 0; i < arrays_length; i++) {
+		jerry_value_free(arrays[i]);
+	}
+	free(arrays);
+
+	return ret;
+}
+
+jerry_value_t isr_module_native_rdata() {
+	const char *names[] = { "ipv4", "ipv6", "domainName", "characterString", "txt", "mx", "srv", "soa", "concat" };
+	const jerry_external_handler_t handlers[] = {
+		&isr_native_rdata_ipv4,
+		&isr_native_rdata_ipv6,
+		&isr_native_rdata_domain_name,
+		&isr_native_rdata_character_string,
+		&isr_native_rdata_txt,
+		&isr_native_rdata_mx,
+		&isr_native_rdata_srv,
+		&isr_native_rdata_soa,
+		&isr_native_rdata_concat,
+	};
+	const size_t count = sizeof(handlers) / sizeof(handlers[0]);
+
+	jerry_value_t exports[sizeof(handlers) / sizeof(handlers[0])];
+	for (size_t i = 0; i < count; i++) {
+		exports[i] = jerry_string_sz(names[i]);
+	}
+
+	jerry_value_t ret = jerry_native_module(NULL, exports, count);
+	if (jerry_value_is_exception(ret)) goto free_exports;
+
+	for (size_t i = 0; i < count; i++) {
+		jerry_value_t val = jerry_function_external(handlers[i]);
+		jerry_value_t set = jerry_native_module_set(ret, exports[i], val);
+		jerry_value_free(val);
+
+		if (jerry_value_is_exception(set)) {
+			jerry_value_free(ret);
+			ret = set;
+			break;
+		}
+		jerry_value_free(set);
+	}
+
+free_exports:
+	for (size_t i = 0; i < count; i++) {
+		jerry_value_free(exports[i]);
+	}
+
+	return ret;
+}
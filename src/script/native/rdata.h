@@ -0,0 +1,20 @@
+/*
+		Copyright (C) 2023
+			Pribess (Heewon Cho)
+			Jhyub	(Janghyub Seo)
+		src/script/native/rdata.h
+*/
+
+#ifndef ISR_SCRIPT_NATIVE_RDATA
+#define ISR_SCRIPT_NATIVE_RDATA
+
+#include <arpa/inet.h>
+#include <jerryscript.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+jerry_value_t isr_module_native_rdata();
+
+#endif
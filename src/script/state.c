@@ -7,6 +7,18 @@
 
 #include "state.h"
 
+extern struct config isr_config;
+
+/*
+	Bumped whenever the data of any state provider changes.
+	Anything derived from the state object (e.g. memoized resolve() decisions)
+	can compare against this instead of re-running the providers.
+*/
+uint32_t isr_script_state_version = 0;
+
+uint64_t isr_script_state_last_refresh = 0;
+bool isr_script_state_refreshed = false;
+
 struct state_providers_and_size {
 	struct state_provider **providers;
 	size_t *size;
@@ -22,7 +34,7 @@ char **isr_script_state_path(jerry_char_t *path_str, jerry_size_t path_str_size,
 		if (path_str[cursor] == '\0') {
 			if(cursor == current_start) continue; /* trailing dot? */
 
-			ret[*path_size] = malloc((cursor - current_start) * sizeof(char));
+			ret[*path_size] = malloc((cursor - current_start + 1) * sizeof(char));
 			strcpy(ret[*path_size], (char *)path_str + current_start);
 			*path_size += 1;
 
@@ -50,7 +62,13 @@ bool isr_script_register_state(const jerry_value_t name, const jerry_value_t val
 	struct state_providers_and_size *data = user_data;
 	
 	struct state_provider *provider = malloc(sizeof(struct state_provider));
-	provider->callback = data_cb;
+	provider->callback = jerry_value_copy(data_cb);
+	provider->path = NULL;
+	provider->path_length = 0;
+	provider->is_first = false;
+	provider->data = jerry_undefined();
+	provider->digest = 0;
+	provider->version = 0;
 
 	data->providers[*data->size] = provider;
 	*data->size += 1;
@@ -133,6 +151,27 @@ free_state_module:
 	return ret;
 }
 
+/*
+	Frees providers, the next refresh then polling whichever providers replace them right away.
+*/
+void isr_script_state_providers_free(struct state_provider **providers, size_t size) {
+	for (size_t i = 0; i < size; i++) {
+		struct state_provider *provider = providers[i];
+
+		jerry_value_free(provider->callback);
+		jerry_value_free(provider->data);
+		for (size_t j = 0; j < provider->path_length; j++) {
+			free(provider->path[j]);
+		}
+		free(provider->path);
+		free(provider);
+	}
+	free(providers);
+
+	isr_script_state_refreshed = false;
+	isr_script_state_version++;
+}
+
 void isr_script_set_data_on_path(char **path, size_t path_length, jerry_value_t on, jerry_value_t data) {
 	char *path_part = path[0];
 
@@ -155,30 +194,79 @@ void isr_script_set_data_on_path(char **path, size_t path_length, jerry_value_t
 	}
 }
 
-jerry_value_t isr_script_object_state(struct state_provider **providers, size_t size) {
-	jerry_value_t ret = jerry_object();
+uint32_t isr_script_state_digest(jerry_value_t data) {
+	/* FNV-1a over the JSON form, which is good enough to notice that a provider returned something else */
+	uint32_t ret = 2166136261u;
 
-	struct state_provider *current_first = NULL;
-	bool current_loaded = false;
-	for (int i = 0; i < size; i++) {
-		struct state_provider *provider = providers[i];
+	jerry_value_t json = jerry_json_stringify(data);
+	if (!jerry_value_is_string(json)) goto free_json;
 
-		if (provider->is_first) {
-			current_first = provider;
-			current_loaded = false;
+	jerry_size_t json_size = jerry_string_size(json, JERRY_ENCODING_UTF8);
+	jerry_char_t *buff = malloc(json_size * sizeof(jerry_char_t));
+	jerry_size_t copied = jerry_string_to_buffer(json, JERRY_ENCODING_UTF8, buff, json_size);
+
+	for (jerry_size_t i = 0; i < copied; i++) {
+		ret ^= buff[i];
+		ret *= 16777619u;
+	}
+
+	free(buff);
+free_json:
+	jerry_value_free(json);
+
+	return ret;
+}
+
+/*
+	Polls every state provider at most once per isr_config.state_refresh_interval
+	and keeps the latest data on the first provider of each name.
+	A name whose data changed gets its version bumped.
+*/
+void isr_script_state_refresh(struct state_provider **providers, size_t size) {
+	uint64_t now = isr_clock_ms();
+	if (isr_script_state_refreshed && now - isr_script_state_last_refresh < isr_config.state_refresh_interval) return;
+	isr_script_state_last_refresh = now;
+	isr_script_state_refreshed = true;
+
+	size_t i = 0;
+	while (i < size) {
+		struct state_provider *first = providers[i];
+
+		jerry_value_t data = jerry_undefined();
+		bool loaded = false;
+
+		do {
+			if (loaded) continue;
+
+			jerry_value_t candidate = jerry_call(providers[i]->callback, jerry_undefined(), NULL, 0);
+			if (jerry_value_is_exception(candidate)) { jerry_value_free(candidate); continue; }
+
+			data = candidate;
+			loaded = true;
+		} while (++i < size && !providers[i]->is_first);
+
+		uint32_t digest = isr_script_state_digest(data);
+		if (digest != first->digest) {
+			first->digest = digest;
+			first->version++;
+			isr_script_state_version++;
 		}
 
-		if (current_loaded) 
-			continue;
+		jerry_value_free(first->data);
+		first->data = data;
+	}
+}
+
+jerry_value_t isr_script_object_state(struct state_provider **providers, size_t size) {
+	jerry_value_t ret = jerry_object();
 
-		jerry_value_t data = jerry_call(provider->callback, jerry_undefined(), NULL, 0);
-		if (jerry_value_is_exception(data)) goto free_data;
+	for (size_t i = 0; i < size; i++) {
+		struct state_provider *provider = providers[i];
 
-		isr_script_set_data_on_path(current_first->path, current_first->path_length, ret, data);
-		current_loaded = true;
+		if (!provider->is_first || jerry_value_is_undefined(provider->data))
+			continue;
 
-free_data:
-		jerry_value_free(data);
+		isr_script_set_data_on_path(provider->path, provider->path_length, ret, provider->data);
 	}
 
 	return ret;
@@ -13,16 +13,27 @@
 #include <stdio.h>
 
 #include "module.h"
+#include "../clock.h"
 
 struct state_provider {
 	jerry_value_t callback;
 	char **path;
 	size_t path_length;
 	bool is_first;
+	/* below are only meaningful on the first provider of a name */
+	jerry_value_t data;
+	uint32_t digest;
+	uint32_t version;
 };
 
+extern uint32_t isr_script_state_version;
+
 struct state_provider **isr_script_state_providers(size_t *size);
 
+void isr_script_state_providers_free(struct state_provider **providers, size_t size);
+
+void isr_script_state_refresh(struct state_provider **providers, size_t size);
+
 jerry_value_t isr_script_object_state(struct state_provider **providers, size_t size);
 
 #endif